@@ -0,0 +1,772 @@
+//
+//  ConcurrentPooledMap.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  ConcurrentPooledMap 功能介绍 / Features
+//  -----------------------------------------------------------------------------
+//
+//  读多写少场景下的并发有序映射（红黑树，节点经 Pool 策略池化分配）：
+//  1. 读操作（find / contains / try_get）不加锁：沿原子子指针下降，
+//     命中即返回；未命中时用 seqlock 式版本号校验，期间有写入则重试。
+//  2. 写操作之间由互斥锁串行化；已发布节点的 key / value 从不原地修改，
+//     赋值会换上新节点。
+//  3. 被删除或替换的节点先进入待回收列表，按纪元 (epoch) 等所有可能看到它的读者
+//     退出后才 recycle 回对象池，读者永远不会访问已被复用的节点。
+//
+//  A concurrent ordered map for read-mostly workloads (red-black tree, nodes
+//  pooled through the Pool policy):
+//  1. Reads (find / contains / try_get) take no lock: they descend along
+//     atomic child pointers and return on a hit; a miss is validated against
+//     a seqlock-style version counter and retried if a write overlapped.
+//  2. Writers are serialized by a mutex. The key and value of a published
+//     node are never modified in place; assignment swaps in a fresh node.
+//  3. Erased or replaced nodes wait on a limbo list and are only recycled to
+//     the pool once every reader that might still see them has left its
+//     epoch, so a reader never touches a node that has been reused.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "PoolPolicy.hpp"
+
+namespace pooled_detail {
+
+/// 读者计数条带数 / Number of reader-count stripes
+constexpr std::size_t reader_stripes = 64;
+
+/// 当前线程固定使用的读者条带 / The reader stripe this thread always uses
+inline std::size_t reader_stripe() noexcept {
+    static std::atomic<std::size_t> next{0};
+    thread_local const std::size_t stripe = next.fetch_add(1, std::memory_order_relaxed) % reader_stripes;
+    return stripe;
+}
+
+} // namespace pooled_detail
+
+/**
+ * @brief 读多写少的并发有序映射 / Concurrent ordered map for read-mostly workloads
+ *
+ * 读者之间、读者与写者之间互不阻塞；写者之间串行。读接口只交出 value 的拷贝或
+ * 在回调期间借出 const 引用，因此回调返回后元素被删除也不会留下悬空引用。
+ *
+ * Readers never block each other or the writer; writers are serialized.
+ * Reads hand out a copy of the value, or lend a const reference for the
+ * duration of a callback, so erasing an element afterwards leaves nothing
+ * dangling.
+ *
+ * @tparam Compare 键比较器，默认 std::less<>（透明，支持异构查找）/
+ *                 Key comparator; defaults to std::less<> (transparent, enables heterogeneous lookup).
+ * @tparam Pool    节点池策略，见 PoolPolicy.hpp；只在持有写锁时使用 /
+ *                 Node pool policy, see PoolPolicy.hpp; only used under the writer lock.
+ */
+template <typename Key, typename Value, typename Compare = std::less<>, typename Pool = SegmentedPoolPolicy>
+class ConcurrentPooledMap {
+    struct Node;
+    using NodeType = Node;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using pool_type = Pool;
+
+    ConcurrentPooledMap() = default;
+    explicit ConcurrentPooledMap(const Compare& comp, const Pool& pool = Pool()) : comp_(comp), pool_(pool) {}
+    explicit ConcurrentPooledMap(const Pool& pool) : pool_(pool) {}
+
+    ConcurrentPooledMap(const ConcurrentPooledMap&) = delete;
+    ConcurrentPooledMap& operator=(const ConcurrentPooledMap&) = delete;
+
+    /// 析构时不得有并发读者 / No reader may be running during destruction
+    ~ConcurrentPooledMap() {
+        clear(root_.load(std::memory_order_relaxed));
+        for (auto& limbo : limbo_) recycle_all(limbo);
+    }
+
+    // ---------- 无锁读 / Lock-free reads ----------
+
+    /**
+     * @brief 查找并拷贝 value / Look up and copy the value out
+     *
+     * 命中时把 value 拷贝到 out 并返回 true；未命中返回 false，out 不变。
+     * Copies the value into out and returns true on a hit; returns false
+     * and leaves out untouched on a miss.
+     */
+    bool find(const Key& key, Value& out) const {
+        return try_get(key, [&out](const Value& v) { out = v; });
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool find(const K& key, Value& out) const {
+        return try_get(key, [&out](const Value& v) { out = v; });
+    }
+
+    /// 判断 key 是否存在 / Check if key exists
+    bool contains(const Key& key) const {
+        ReadGuard guard(*this);
+        return find_node(key) != nullptr;
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const {
+        ReadGuard guard(*this);
+        return find_node(key) != nullptr;
+    }
+
+    /**
+     * @brief 命中时以 const 引用调用 func / Call func with a const reference on a hit
+     *
+     * 引用只在 func 执行期间有效；func 内不得调用本容器的写接口。
+     * The reference is only valid while func runs; func must not call the
+     * writer interface of this map.
+     */
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) const { return try_get_impl(key, func); }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) const { return try_get_impl(key, func); }
+
+    /// 元素个数（读时可能已过期）/ Number of elements (may be stale by the time it is read)
+    std::size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+    /// 判断是否为空 / Check if empty
+    bool empty() const noexcept { return size() == 0; }
+
+    /// 返回比较器 / Return the key comparator
+    Compare key_comp() const { return comp_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    /// 节点池统计（含尚在纪元回收队列中的节点），见 PoolStats.hpp / Node pool statistics (nodes awaiting epoch reclamation count as live), see PoolStats.hpp
+    PoolStats pool_stats() const { return pool_.template stats<Node>(); }
+#endif
+
+    // ---------- 写操作（串行化）/ Writes (serialized) ----------
+
+    /**
+     * @brief key 不存在时才原位构造 value / Construct the value in place only if key is absent
+     *
+     * 返回 true 表示发生了插入；命中时不会移动或消耗参数。
+     * Returns true when an insertion happened; on a hit the arguments are
+     * left untouched.
+     */
+    template <typename... Args>
+    bool try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool try_emplace(Key&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 插入或赋值 / Insert, or replace the existing value
+     *
+     * key 已存在时以新节点替换旧节点（旧节点延迟回收，正在读它的读者不受影响），
+     * 否则插入新节点。返回 true 表示发生了插入。
+     *
+     * If key is present a fresh node replaces the old one (the old node is
+     * reclaimed later, so readers still on it are unaffected); otherwise a new
+     * node is inserted. Returns true when an insertion happened.
+     */
+    template <typename M>
+    bool insert_or_assign(const Key& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    bool insert_or_assign(Key&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+    }
+
+    /// 删除 key，返回删除的元素个数 / Erase key, returning the number of elements removed
+    std::size_t erase(const Key& key) { return erase_impl(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t erase(const K& key) { return erase_impl(key); }
+
+    /**
+     * @brief 清空所有元素 / Remove every element
+     *
+     * 整棵树一次摘下，节点随后按纪元回收。
+     * The whole tree is detached at once; its nodes are reclaimed by epoch afterwards.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        NodeType* old = root_.load(std::memory_order_relaxed);
+        if (!old) return;
+        begin_write();
+        root_.store(nullptr, std::memory_order_release);
+        size_.store(0, std::memory_order_relaxed);
+        end_write();
+        retire_subtree(old);
+        try_reclaim();
+    }
+
+    /**
+     * @brief 在写锁下按升序遍历 / In-order traversal under the writer lock
+     *
+     * 遍历期间写者被阻塞，读者不受影响。
+     * Blocks writers for the duration; readers are unaffected.
+     */
+    template <typename Func>
+    void for_each(Func&& func) const {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        NodeType* cur = root_.load(std::memory_order_relaxed);
+        cur = cur ? minimum(cur) : nullptr;
+        for (; cur; cur = successor(cur)) func(cur->key, cur->value);
+    }
+
+    /**
+     * @brief 等待并回收所有待回收节点 / Wait for and reclaim every retired node
+     *
+     * 写操作已尽量非阻塞地回收；需要确定性地归还内存时调用。
+     * Writes already reclaim opportunistically without blocking; call this
+     * when memory has to be returned deterministically.
+     */
+    void synchronize() {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        while (!limbo_[0].empty() || !limbo_[1].empty()) {
+            if (!try_advance()) std::this_thread::yield();
+        }
+    }
+
+    /// 尚未回收的节点数 / Number of retired nodes not yet reclaimed
+    std::size_t retired_count() const {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        return limbo_[0].size() + limbo_[1].size();
+    }
+
+private:
+    // ---------- 内部定义 / Internal definitions ----------
+    enum Color { RED = 0, BLACK = 1 };
+
+    /**
+     * @brief 红黑树节点 / Red-black tree node
+     *
+     * left / right 为原子指针，供读者并发下降；parent 与颜色只由写者访问。
+     * key / value 在发布前构造完成，此后只读。
+     *
+     * left / right are atomic so readers can descend concurrently; parent and
+     * color are only touched by the writer. key / value are built before the
+     * node is published and are read-only afterwards.
+     */
+    struct Node : public Pool::template node_base<Node> {
+        Key key;
+        Value value;
+        std::atomic<Node*> left{nullptr};
+        std::atomic<Node*> right{nullptr};
+        Node* parent = nullptr;
+        Color color = RED;
+
+        // 分段构造 / Piecewise construction
+        template <typename KArgs, typename VArgs>
+        Node(std::piecewise_construct_t, KArgs&& kargs, VArgs&& vargs)
+            : key(std::make_from_tuple<Key>(std::forward<KArgs>(kargs))),
+              value(std::make_from_tuple<Value>(std::forward<VArgs>(vargs))) {}
+    };
+
+    /// 按线程分条的读者计数，每条独占一个缓存行 / Per-thread reader counts, one cache line per stripe
+    struct alignas(64) ReaderStripe {
+        std::atomic<std::uint32_t> active[2] = {};
+    };
+
+    /**
+     * @brief 读者纪元登记 / Reader epoch registration
+     *
+     * 在当前纪元奇偶对应的计数上加一后复核纪元；纪元已变则退回重试，
+     * 保证写者检查计数时不会漏掉已开始读取的读者。
+     *
+     * Bumps the count for the current epoch's parity and re-checks the epoch,
+     * backing out and retrying if it moved, so the writer never misses a
+     * reader that has started reading.
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const ConcurrentPooledMap& map) {
+            ReaderStripe& stripe = map.readers_[pooled_detail::reader_stripe()];
+            for (;;) {
+                std::uint64_t e = map.epoch_.load(std::memory_order_seq_cst);
+                count_ = &stripe.active[e & 1];
+                count_->fetch_add(1, std::memory_order_seq_cst);
+                if (map.epoch_.load(std::memory_order_seq_cst) == e) break;
+                count_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+        ~ReadGuard() { count_->fetch_sub(1, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        std::atomic<std::uint32_t>* count_;
+    };
+
+    // 合法红黑树的高度上限，下降超过此步数说明读到了写者的中间状态
+    // Height bound of any valid red-black tree; a longer descent means the
+    // reader saw a writer's intermediate state.
+    static constexpr std::size_t max_descent = 2 * std::numeric_limits<std::size_t>::digits;
+
+    std::atomic<NodeType*> root_{nullptr};          ///< 根节点 / Root node
+    std::atomic<std::size_t> size_{0};              ///< 节点数量 / Number of nodes
+    std::atomic<std::uint64_t> version_{0};         ///< 写入中为奇数 / Odd while a write is in progress
+    std::atomic<std::uint64_t> epoch_{0};           ///< 回收纪元 / Reclamation epoch
+    mutable ReaderStripe readers_[pooled_detail::reader_stripes];
+    std::vector<NodeType*> limbo_[2];               ///< 按纪元奇偶分组的待回收节点 / Retired nodes by epoch parity
+    mutable std::mutex write_mutex_;                ///< 写者互斥 / Serializes writers
+    Compare comp_;                                  ///< 键比较器 / Key comparator
+    Pool pool_;                                     ///< 节点池策略 / Node pool policy
+
+    static NodeType* left(const NodeType* n) noexcept { return n->left.load(std::memory_order_relaxed); }
+    static NodeType* right(const NodeType* n) noexcept { return n->right.load(std::memory_order_relaxed); }
+    static void set_left(NodeType* n, NodeType* c) noexcept { n->left.store(c, std::memory_order_release); }
+    static void set_right(NodeType* n, NodeType* c) noexcept { n->right.store(c, std::memory_order_release); }
+
+    // ---------- 读路径 / Read path ----------
+
+    /**
+     * @brief 无锁精确查找，须在 ReadGuard 内调用 / Lock-free exact match; call inside a ReadGuard
+     *
+     * 找到的节点必定在本次读取期间的某一时刻位于树中；未命中只有在整个下降期间
+     * 没有写入（版本号为偶数且不变）时才成立，否则重试。
+     *
+     * A node it finds was in the tree at some instant during the read. A miss
+     * only stands if no write overlapped the descent (the version was even
+     * and unchanged); otherwise the descent is retried.
+     */
+    template <typename K>
+    NodeType* find_node(const K& key) const {
+        for (;;) {
+            std::uint64_t v = version_.load(std::memory_order_acquire);
+            NodeType* cur = root_.load(std::memory_order_acquire);
+            NodeType* candidate = nullptr;
+            for (std::size_t depth = 0; cur && depth < max_descent; ++depth) {
+                if (comp_(cur->key, key)) cur = cur->right.load(std::memory_order_acquire);
+                else { candidate = cur; cur = cur->left.load(std::memory_order_acquire); }
+            }
+            if (candidate && !comp_(key, candidate->key)) return candidate;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (!(v & 1) && version_.load(std::memory_order_relaxed) == v) return nullptr;
+            std::this_thread::yield();
+        }
+    }
+
+    template <typename K, typename Func>
+    bool try_get_impl(const K& key, Func& func) const {
+        ReadGuard guard(*this);
+        NodeType* node = find_node(key);
+        if (!node) return false;
+        func(static_cast<const Value&>(node->value));
+        return true;
+    }
+
+    // ---------- 纪元回收 / Epoch-based reclamation ----------
+    //
+    // 第 e 纪元内摘下的节点进入 limbo_[e & 1]。纪元从 e 推进到 e+1 要求
+    // 第 e-1 纪元的读者全部退出：此时第 e-1 纪元摘下的节点已无人可见，整批 recycle，
+    // 然后该列表开始收集第 e+1 纪元的节点。
+    //
+    // Nodes retired during epoch e go to limbo_[e & 1]. Advancing from e to
+    // e+1 requires every reader of epoch e-1 to have left; by then nothing can
+    // reach the nodes retired during e-1, so the whole batch is recycled and
+    // that list starts collecting epoch e+1.
+
+    void begin_write() noexcept {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void end_write() noexcept {
+        version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void retire(NodeType* node) {
+        limbo_[epoch_.load(std::memory_order_relaxed) & 1].push_back(node);
+    }
+
+    // 摘下的整棵子树逐个进入待回收列表 / Retire every node of a detached subtree
+    void retire_subtree(NodeType* node) {
+        for (NodeType* cur = node ? minimum(node) : nullptr; cur; cur = successor(cur)) retire(cur);
+    }
+
+    bool try_advance() {
+        std::uint64_t e = epoch_.load(std::memory_order_relaxed);
+        std::size_t stale = (e + 1) & 1;
+        for (const ReaderStripe& stripe : readers_) {
+            if (stripe.active[stale].load(std::memory_order_acquire) != 0) return false;
+        }
+        recycle_all(limbo_[stale]);
+        epoch_.store(e + 1, std::memory_order_seq_cst);
+        return true;
+    }
+
+    // 非阻塞地尝试两次推进，读者空闲时本次摘下的节点立即回收
+    // Two non-blocking attempts; with no readers in flight the nodes retired
+    // by this write are recycled right away.
+    void try_reclaim() {
+        if (limbo_[0].empty() && limbo_[1].empty()) return;
+        if (try_advance()) try_advance();
+    }
+
+    void recycle_all(std::vector<NodeType*>& limbo) noexcept {
+        for (NodeType* n : limbo) pool_.recycle(n);
+        limbo.clear();
+    }
+
+    // ---------- 写路径 / Write path ----------
+
+    // 写者视角的精确查找（树在写锁下稳定）/ Writer-side exact match (the tree is stable under the lock)
+    template <typename K>
+    NodeType* find_locked(const K& key) const {
+        NodeType* cur = root_.load(std::memory_order_relaxed);
+        NodeType* candidate = nullptr;
+        while (cur) {
+            if (comp_(cur->key, key)) cur = right(cur);
+            else { candidate = cur; cur = left(cur); }
+        }
+        return (candidate && !comp_(key, candidate->key)) ? candidate : nullptr;
+    }
+
+    struct InsertPos {
+        NodeType* parent;
+        NodeType* match;
+        bool left;
+    };
+
+    template <typename K>
+    InsertPos find_insert_pos(const K& key) const {
+        NodeType* cur = root_.load(std::memory_order_relaxed);
+        NodeType* parent = nullptr;
+        NodeType* candidate = nullptr;
+        bool go_left = false;
+        while (cur) {
+            parent = cur;
+            go_left = !comp_(cur->key, key);
+            if (go_left) { candidate = cur; cur = left(cur); }
+            else cur = right(cur);
+        }
+        if (candidate && !comp_(key, candidate->key)) return { parent, candidate, go_left };
+        return { parent, nullptr, go_left };
+    }
+
+    template <typename K, typename... Args>
+    bool try_emplace_impl(K&& key, Args&&... args) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        InsertPos pos = find_insert_pos(key);
+        if (pos.match) return false;
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+        link_node(node, pos);
+        return true;
+    }
+
+    template <typename K, typename M>
+    bool insert_or_assign_impl(K&& key, M&& obj) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        InsertPos pos = find_insert_pos(key);
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<M>(obj)));
+        if (!pos.match) {
+            link_node(node, pos);
+            return true;
+        }
+        replace_node(pos.match, node);
+        retire(pos.match);
+        try_reclaim();
+        return false;
+    }
+
+    template <typename K>
+    std::size_t erase_impl(const K& key) {
+        std::lock_guard<std::mutex> lock(write_mutex_);
+        NodeType* z = find_locked(key);
+        if (!z) return 0;
+        begin_write();
+        unlink_node(z);
+        end_write();
+        retire(z);
+        try_reclaim();
+        return 1;
+    }
+
+    // 挂接新节点并修复；子指针的 release 写入同时发布节点内容
+    // Link a fresh node and rebalance; the release store of the child pointer
+    // also publishes the node's contents.
+    void link_node(NodeType* node, const InsertPos& pos) {
+        node->parent = pos.parent;
+        node->color = RED;
+        begin_write();
+        if (!pos.parent) root_.store(node, std::memory_order_release);
+        else if (pos.left) set_left(pos.parent, node);
+        else set_right(pos.parent, node);
+        fix_insert(node);
+        end_write();
+        size_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 以 fresh 原位顶替 old：键相同，树形不变 / Put fresh exactly where old was: same key, same shape
+    void replace_node(NodeType* old, NodeType* fresh) {
+        NodeType* l = left(old);
+        NodeType* r = right(old);
+        fresh->color = old->color;
+        fresh->parent = old->parent;
+        fresh->left.store(l, std::memory_order_relaxed);
+        fresh->right.store(r, std::memory_order_relaxed);
+        if (l) l->parent = fresh;
+        if (r) r->parent = fresh;
+        // 键相同，读者无论看到新旧节点都能命中，无需改版本号
+        // Same key: a reader hits whichever of the two it sees, so the version stays put.
+        replace_child(old->parent, old, fresh);
+    }
+
+    void replace_child(NodeType* parent, NodeType* old, NodeType* child) noexcept {
+        if (!parent) root_.store(child, std::memory_order_release);
+        else if (left(parent) == old) set_left(parent, child);
+        else set_right(parent, child);
+    }
+
+    // 左旋 / Left rotation
+    void rotate_left(NodeType* x) {
+        NodeType* y = right(x);
+        NodeType* b = left(y);
+        set_right(x, b);
+        if (b) b->parent = x;
+        y->parent = x->parent;
+        replace_child(x->parent, x, y);
+        set_left(y, x);
+        x->parent = y;
+    }
+
+    // 右旋 / Right rotation
+    void rotate_right(NodeType* x) {
+        NodeType* y = left(x);
+        NodeType* b = right(y);
+        set_left(x, b);
+        if (b) b->parent = x;
+        y->parent = x->parent;
+        replace_child(x->parent, x, y);
+        set_right(y, x);
+        x->parent = y;
+    }
+
+    static bool is_red(const NodeType* n) noexcept { return n && n->color == RED; }
+
+    // 插入修复 / Fix properties after insertion
+    void fix_insert(NodeType* z) {
+        while (is_red(z->parent)) {
+            NodeType* p = z->parent;
+            NodeType* g = p->parent;
+            if (p == left(g)) {
+                NodeType* y = right(g);
+                if (is_red(y)) {
+                    // Case 1: 叔叔为红色 / Uncle is red
+                    p->color = BLACK;
+                    y->color = BLACK;
+                    g->color = RED;
+                    z = g;
+                } else {
+                    if (z == right(p)) {
+                        // Case 2: 内旋转 / Inner rotation
+                        z = p;
+                        rotate_left(z);
+                    }
+                    // Case 3: 外旋转 / Outer rotation
+                    z->parent->color = BLACK;
+                    g->color = RED;
+                    rotate_right(g);
+                }
+            } else {
+                NodeType* y = left(g);
+                if (is_red(y)) {
+                    p->color = BLACK;
+                    y->color = BLACK;
+                    g->color = RED;
+                    z = g;
+                } else {
+                    if (z == left(p)) {
+                        z = p;
+                        rotate_right(z);
+                    }
+                    z->parent->color = BLACK;
+                    g->color = RED;
+                    rotate_left(g);
+                }
+            }
+        }
+        root_.load(std::memory_order_relaxed)->color = BLACK;
+    }
+
+    // 子树替换 / Subtree transplant
+    void transplant(NodeType* u, NodeType* v) {
+        replace_child(u->parent, u, v);
+        if (v) v->parent = u->parent;
+    }
+
+    // 摘除节点并修复（不回收）/ Unlink a node and rebalance (without recycling it)
+    void unlink_node(NodeType* z) {
+        NodeType* y = z;
+        Color y_original_color = y->color;
+        NodeType* x = nullptr;
+        NodeType* x_parent = nullptr;
+
+        if (!left(z)) {
+            x = right(z);
+            x_parent = z->parent;
+            transplant(z, x);
+        } else if (!right(z)) {
+            x = left(z);
+            x_parent = z->parent;
+            transplant(z, x);
+        } else {
+            y = minimum(right(z));
+            y_original_color = y->color;
+            x = right(y);
+            if (y->parent == z) {
+                if (x) x->parent = y;
+                x_parent = y;
+            } else {
+                transplant(y, x);
+                set_right(y, right(z));
+                right(y)->parent = y;
+                x_parent = y->parent;
+            }
+            transplant(z, y);
+            set_left(y, left(z));
+            left(y)->parent = y;
+            y->color = z->color;
+        }
+        size_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (y_original_color == BLACK) fix_erase(x, x_parent);
+    }
+
+    // 删除修复 / Fix properties after deletion
+    void fix_erase(NodeType* x, NodeType* x_parent) {
+        while (x != root_.load(std::memory_order_relaxed) && !is_red(x)) {
+            if (x == left(x_parent)) {
+                NodeType* w = right(x_parent);
+                if (is_red(w)) {
+                    // Case 1: 兄弟为红色 / Sibling is red
+                    w->color = BLACK;
+                    x_parent->color = RED;
+                    rotate_left(x_parent);
+                    w = right(x_parent);
+                }
+                if (!is_red(left(w)) && !is_red(right(w))) {
+                    // Case 2: 两个子节点都是黑色 / Both children black
+                    w->color = RED;
+                    x = x_parent;
+                    x_parent = x->parent;
+                } else {
+                    if (!is_red(right(w))) {
+                        left(w)->color = BLACK;
+                        w->color = RED;
+                        rotate_right(w);
+                        w = right(x_parent);
+                    }
+                    // Case 3: 修复并旋转 / Fix and rotate
+                    w->color = x_parent->color;
+                    x_parent->color = BLACK;
+                    if (right(w)) right(w)->color = BLACK;
+                    rotate_left(x_parent);
+                    x = root_.load(std::memory_order_relaxed);
+                }
+            } else {
+                NodeType* w = left(x_parent);
+                if (is_red(w)) {
+                    w->color = BLACK;
+                    x_parent->color = RED;
+                    rotate_right(x_parent);
+                    w = left(x_parent);
+                }
+                if (!is_red(right(w)) && !is_red(left(w))) {
+                    w->color = RED;
+                    x = x_parent;
+                    x_parent = x->parent;
+                } else {
+                    if (!is_red(left(w))) {
+                        right(w)->color = BLACK;
+                        w->color = RED;
+                        rotate_left(w);
+                        w = left(x_parent);
+                    }
+                    w->color = x_parent->color;
+                    x_parent->color = BLACK;
+                    if (left(w)) left(w)->color = BLACK;
+                    rotate_right(x_parent);
+                    x = root_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        if (x) x->color = BLACK;
+    }
+
+    // 查找最小节点 / Find minimum node
+    static NodeType* minimum(NodeType* node) noexcept {
+        while (left(node)) node = left(node);
+        return node;
+    }
+
+    // 中序后继 / In-order successor
+    static NodeType* successor(NodeType* node) noexcept {
+        if (right(node)) return minimum(right(node));
+        NodeType* p = node->parent;
+        while (p && node == right(p)) {
+            node = p;
+            p = p->parent;
+        }
+        return p;
+    }
+
+    // 析构时后序回收整棵子树，边回收边摘除叶子 / Post-order recycle at destruction, detaching leaves as it goes
+    void clear(NodeType* node) noexcept {
+        NodeType* cur = node;
+        while (cur) {
+            if (NodeType* l = left(cur)) { cur = l; continue; }
+            if (NodeType* r = right(cur)) { cur = r; continue; }
+            NodeType* parent = cur->parent;
+            bool last = (cur == node);
+            if (!last) {
+                if (left(parent) == cur) parent->left.store(nullptr, std::memory_order_relaxed);
+                else parent->right.store(nullptr, std::memory_order_relaxed);
+            }
+            pool_.recycle(cur);
+            cur = last ? nullptr : parent;
+        }
+    }
+};
@@ -0,0 +1,229 @@
+/*
+ * ImplicitTreap.hpp
+ *
+ * 版权所有 (c) 2025 大熊哥哥 (Bighiung)
+ * All rights reserved / 保留所有权利
+ *
+ * 使用许可 / License Terms:
+ *
+ * 本代码允许在个人、学术及商业项目中自由使用、修改和分发，
+ * 但必须在所有副本及衍生作品中保留本声明，且明确标注作者为：
+ *
+ *      大熊哥哥 (Bighiung)
+ *
+ * 禁止去除或修改此版权声明。
+ *
+ * This code is free to use, modify, and distribute in personal,
+ * academic, and commercial projects, provided that this notice
+ * is retained in all copies or derivative works, and the author
+ * is explicitly acknowledged as:
+ *
+ *      大熊哥哥 (Bighiung)
+ *
+ * Removal or alteration of this copyright notice is prohibited.
+ *
+ * ---------------------------------------------------------------
+ *
+ * ImplicitTreap - 侵入式隐式键 Treap 位置索引
+ *
+ * 功能 / Features:
+ * 1. 以子树权重作为隐式键，按位置而非按值组织节点 / Nodes are keyed implicitly by position (subtree weights).
+ * 2. 直接挂在池化节点上，不额外分配内存 / Intrusive: links live inside the pooled nodes, no extra allocation.
+ * 3. 定位、插入、删除均为期望 O(log n) / Expected O(log n) locate, link and unlink.
+ * 4. 支持按位置切分与拼接整棵子树 / Supports cutting and pasting whole position ranges in O(log n).
+ *
+ * 节点需要提供成员 / Node must provide members:
+ *     Node* _left; Node* _right; Node* _parent; std::size_t _count; std::uint32_t _priority;
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace pooled_detail {
+
+// 线程局部 xorshift 随机优先级 / Thread-local xorshift priority source
+inline std::uint32_t treap_priority() noexcept {
+    static thread_local std::uint64_t state =
+        0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(&state));
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<std::uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+// 每个节点占一个位置 / Every node occupies exactly one position
+struct UnitWeight {
+    template <typename Node>
+    static constexpr std::size_t of(const Node*) noexcept { return 1; }
+};
+
+} // namespace pooled_detail
+
+template <typename Node, typename Weight = pooled_detail::UnitWeight>
+class ImplicitTreap {
+public:
+    Node* root() const noexcept { return _root; }
+    std::size_t total() const noexcept { return count(_root); }
+    void reset() noexcept { _root = nullptr; }
+
+    Node* release() noexcept {
+        Node* r = _root;
+        _root = nullptr;
+        return r;
+    }
+
+    void swap(ImplicitTreap& other) noexcept {
+        Node* r = _root;
+        _root = other._root;
+        other._root = r;
+    }
+
+    // -------- 定位 / Locate --------
+    // 返回包含位置 idx 的节点，idx 被改写为节点内偏移 / Returns node holding position idx; idx becomes the offset inside it
+    Node* locate(std::size_t& idx) const noexcept {
+        Node* cur = _root;
+        while (cur) {
+            std::size_t l = count(cur->_left);
+            if (idx < l) { cur = cur->_left; continue; }
+            idx -= l;
+            std::size_t w = Weight::of(cur);
+            if (idx < w) return cur;
+            idx -= w;
+            cur = cur->_right;
+        }
+        return nullptr;
+    }
+
+    // 节点首元素的位置 / Position of the node's first element
+    std::size_t position(const Node* n) const noexcept {
+        std::size_t pos = count(n->_left);
+        for (const Node* p = n->_parent; p; n = p, p = p->_parent) {
+            if (n == p->_right) pos += count(p->_left) + Weight::of(p);
+        }
+        return pos;
+    }
+
+    // -------- 挂接 / Link --------
+    // 将 n 放在中序相邻的 prev 与 next 之间 / Link n between in-order neighbours prev and next
+    void link(Node* n, Node* prev, Node* next) noexcept {
+        n->_left = n->_right = nullptr;
+        n->_count = Weight::of(n);
+        n->_priority = pooled_detail::treap_priority();
+        // 相邻两节点中必有一个在该方向上没有孩子 / One of two adjacent nodes always has the free slot
+        if (prev && !prev->_right) { prev->_right = n; n->_parent = prev; }
+        else if (next) { next->_left = n; n->_parent = next; }
+        else { n->_parent = nullptr; _root = n; }
+
+        for (Node* p = n->_parent; p; p = p->_parent) p->_count += n->_count;
+        while (n->_parent && n->_parent->_priority < n->_priority) rotate_up(n);
+    }
+
+    // -------- 摘除 / Unlink --------
+    void unlink(Node* n) noexcept {
+        while (n->_left && n->_right) {
+            rotate_up(n->_left->_priority > n->_right->_priority ? n->_left : n->_right);
+        }
+        Node* child = n->_left ? n->_left : n->_right;
+        Node* parent = n->_parent;
+        std::size_t w = n->_count - count(child);
+        if (child) child->_parent = parent;
+        if (!parent) _root = child;
+        else if (parent->_left == n) parent->_left = child;
+        else parent->_right = child;
+        for (; parent; parent = parent->_parent) parent->_count -= w;
+        n->_left = n->_right = n->_parent = nullptr;
+    }
+
+    // 节点自身权重变化后更新祖先 / Propagate a change of the node's own weight
+    void adjust(Node* n, std::ptrdiff_t delta) noexcept {
+        for (; n; n = n->_parent) n->_count = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(n->_count) + delta);
+    }
+
+    // -------- 区间切分与拼接 / Range cut & paste --------
+    // 取出位置 [first, last) 的子树（边界须落在节点边界上）/ Detach positions [first, last); bounds must fall on node boundaries
+    Node* cut(std::size_t first, std::size_t last) noexcept {
+        Node *left, *mid, *right;
+        split(_root, first, left, mid);
+        detach(left);
+        detach(mid);
+        split(mid, last - first, mid, right);
+        detach(mid);
+        detach(right);
+        _root = join(left, right);
+        return mid;
+    }
+
+    // 在位置 pos 处插入一整棵子树 / Insert a whole detached subtree at position pos
+    void paste(std::size_t pos, Node* sub) noexcept {
+        if (!sub) return;
+        Node *left, *right;
+        split(_root, pos, left, right);
+        detach(left);
+        detach(right);
+        _root = join(join(left, sub), right);
+    }
+
+private:
+    Node* _root = nullptr;
+
+    static std::size_t count(const Node* n) noexcept { return n ? n->_count : 0; }
+
+    static void pull(Node* n) noexcept {
+        n->_count = count(n->_left) + count(n->_right) + Weight::of(n);
+    }
+
+    static void detach(Node* n) noexcept { if (n) n->_parent = nullptr; }
+
+    // 将 x 与其父节点旋转 / Rotate x above its parent
+    void rotate_up(Node* x) noexcept {
+        Node* p = x->_parent;
+        Node* g = p->_parent;
+        if (x == p->_left) {
+            p->_left = x->_right;
+            if (x->_right) x->_right->_parent = p;
+            x->_right = p;
+        } else {
+            p->_right = x->_left;
+            if (x->_left) x->_left->_parent = p;
+            x->_left = p;
+        }
+        p->_parent = x;
+        x->_parent = g;
+        if (!g) _root = x;
+        else if (g->_left == p) g->_left = x;
+        else g->_right = x;
+        x->_count = p->_count;
+        pull(p);
+    }
+
+    static void split(Node* t, std::size_t k, Node*& l, Node*& r) noexcept {
+        if (!t) { l = r = nullptr; return; }
+        std::size_t lc = count(t->_left);
+        if (k <= lc) {
+            split(t->_left, k, l, t->_left);
+            if (t->_left) t->_left->_parent = t;
+            r = t;
+        } else {
+            split(t->_right, k - lc - Weight::of(t), t->_right, r);
+            if (t->_right) t->_right->_parent = t;
+            l = t;
+        }
+        pull(t);
+    }
+
+    static Node* join(Node* l, Node* r) noexcept {
+        if (!l) return r;
+        if (!r) return l;
+        if (l->_priority > r->_priority) {
+            l->_right = join(l->_right, r);
+            l->_right->_parent = l;
+            pull(l);
+            return l;
+        }
+        r->_left = join(l, r->_left);
+        r->_left->_parent = r;
+        pull(r);
+        return r;
+    }
+};
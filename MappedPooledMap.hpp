@@ -0,0 +1,872 @@
+//
+//  MappedPooledMap.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  MappedPooledMap 功能介绍 / Features
+//  -----------------------------------------------------------------------------
+//
+//  节点存放在内存映射文件中的红黑树，用于 Key / Value 均可平凡复制的场景：
+//  1. 整个文件就是节点池：文件头之后是定长节点槽，按段倍增扩展，
+//     删除的节点挂入文件内的空闲链，下次插入复用。
+//  2. 节点之间以相对文件起点的偏移量链接，不存裸指针，文件映射到任何地址都有效；
+//     open() 只做 mmap 与文件头校验，无反序列化，多 GB 的映射也是毫秒级打开，
+//     页面在首次访问时才由内核读入。
+//  3. 只读或读写打开；读写方式下修改直接落在共享映射上，flush() 以 msync 写回磁盘。
+//
+//  A red-black tree whose nodes live in a memory-mapped file, for trivially
+//  copyable Key / Value:
+//  1. The file is the node pool: fixed-size node slots follow the header,
+//     the file grows in doubling segments, and erased nodes go onto a free
+//     list inside the file for the next insertion to reuse.
+//  2. Nodes link to each other by offsets from the start of the file rather
+//     than raw pointers, so the file is valid wherever it is mapped. open()
+//     only maps the file and checks its header, with no deserialization, so
+//     even a multi-GB map opens in milliseconds; pages are read in by the
+//     kernel on first touch.
+//  3. Open read-only or read-write; in read-write mode changes land directly
+//     in the shared mapping and flush() writes them back with msync.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  error "MappedPooledMap requires POSIX mmap"
+#endif
+
+namespace pooled_detail {
+
+/**
+ * @brief 映射文件头，位于偏移 0 / Mapped file header at offset 0
+ *
+ * 记录键值与节点的尺寸，打开时逐项校验，防止以不同的类型或平台打开同一文件。
+ * Records key, value and node sizes, all checked on open so a file is never
+ * read back with different types or on a different platform.
+ */
+struct MappedHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;    ///< 写入方的字节序标记 / byte-order mark of the writer
+    std::uint64_t key_size;
+    std::uint64_t key_align;
+    std::uint64_t value_size;
+    std::uint64_t value_align;
+    std::uint64_t node_size;
+    std::uint64_t root;          ///< 根节点偏移，0 为空树 / root offset, 0 for an empty tree
+    std::uint64_t size;          ///< 元素数 / element count
+    std::uint64_t free_head;     ///< 空闲链头偏移 / free list head offset
+    std::uint64_t used;          ///< 已切分出的字节数 / bytes carved out so far
+    std::uint64_t capacity;      ///< 头部记下的文件字节数，可能小于实际文件 / file size as recorded; may lag the actual file
+};
+
+inline constexpr char mapped_magic[8] = { 'P', 'M', 'A', 'P', 'F', 'I', 'L', 'E' };
+inline constexpr std::uint32_t mapped_version = 1;
+inline constexpr std::uint32_t mapped_byte_order = 0x01020304u;
+
+[[noreturn]] inline void throw_errno(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace pooled_detail
+
+/**
+ * @brief 内存映射文件上的有序映射 / Ordered map backed by a memory-mapped file
+ *
+ * 树的算法与 PooledMap 相同（父指针与颜色合并存放、每层一次比较），链接换成文件内偏移。
+ * 插入导致文件扩展时会重新映射：迭代器只记录偏移，始终有效；
+ * find_ptr() 返回的指针与 value() 引用在下一次可能扩展文件的插入后失效。
+ * 文件内容视为可信，不校验节点偏移；修改不是崩溃原子的，
+ * 崩溃前未 flush() 的修改可能只有一部分写入文件，需由上层日志补齐。
+ * Compare 不写入文件，打开时须与建立文件时一致。只允许单个进程以读写方式打开；
+ * 只读方式的映射没有写权限，经 find_ptr() 或 value() 写入会触发段错误。
+ * 扩展时先加长文件再更新头部的 capacity，因此 capacity 可能小于文件大小（崩溃于两步之间，
+ * 或读方恰在写方扩展时打开），但不会超过它；打开时只要求 used <= capacity <= 文件大小，
+ * 读写方式打开时把 capacity 改为实际映射大小。
+ *
+ * Uses PooledMap's tree algorithms (parent and color packed into one word,
+ * one comparison per level) with in-file offsets as links. An insertion
+ * that grows the file remaps it: iterators hold offsets and stay valid,
+ * while pointers from find_ptr() and value() references are invalidated by
+ * the next insertion that may grow the file. The file is trusted and node
+ * offsets are not validated. Updates are not crash-atomic: changes made
+ * after the last flush() may reach the file partially, and a journal on
+ * top has to make up for them. Compare is not stored in the file and must
+ * match the one the file was built with. Only one process may open a file
+ * read-write. A read-only map is mapped without write access, so writing
+ * through find_ptr() or value() faults.
+ * Growth lengthens the file before it updates the header's capacity, so
+ * capacity may be smaller than the file (after a crash between the two
+ * steps, or when a reader opens while the writer grows) but never larger.
+ * Opening only requires used <= capacity <= file size, and a read-write
+ * open sets capacity to the mapped size.
+ *
+ * @tparam Compare 键比较器，默认 std::less<>（透明，支持异构查找）/
+ *                 Key comparator; defaults to std::less<> (transparent, enables heterogeneous lookup).
+ */
+template <typename Key, typename Value, typename Compare = std::less<>>
+class MappedPooledMap {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "MappedPooledMap stores Key and Value in the file as raw bytes");
+
+    using Ref = std::uint64_t;   ///< 相对文件起点的节点偏移，0 为空 / node offset from the file start, 0 for none
+    struct Node;
+
+public:
+    enum class Mode { ReadOnly, ReadWrite };
+
+    /// 新建文件的默认大小 / Default size of a new file
+    static constexpr std::size_t default_initial_bytes = std::size_t(1) << 20;
+
+    /**
+     * @brief 迭代器，只记录节点偏移，文件重新映射后仍然有效 / Iterator holding a node offset, valid across remaps
+     *
+     * 解引用得到 `std::pair<const Key&, Value&>` 代理，同 PooledMap。
+     * Dereferencing yields a `std::pair<const Key&, Value&>` proxy as in PooledMap.
+     */
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = std::pair<const Key, Value>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::pair<const Key&, std::conditional_t<Const, const Value&, Value&>>;
+
+        /// 箭头运算符代理 / Proxy returned by operator->
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        basic_iterator() = default;
+
+        /// 非 const 迭代器可隐式转换为 const 迭代器 / iterator converts to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept
+            : node_(other.node_), map_(other.map_) {}
+
+        reference operator*() const noexcept { return reference(key(), value()); }
+        pointer operator->() const noexcept { return pointer{**this}; }
+
+        const Key& key() const noexcept { return map_->nd(node_).key; }
+        std::conditional_t<Const, const Value&, Value&> value() const noexcept { return map_->nd(node_).value; }
+
+        basic_iterator& operator++() noexcept {
+            node_ = map_->successor(node_);
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        /// end() 自减得到最大节点 / Decrementing end() yields the maximum node
+        basic_iterator& operator--() noexcept {
+            Ref root = map_->header()->root;
+            node_ = node_ ? map_->predecessor(node_) : (root ? map_->maximum(root) : 0);
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const noexcept { return node_ == other.node_; }
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const noexcept { return node_ != other.node_; }
+
+    private:
+        friend class MappedPooledMap;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(Ref node, const MappedPooledMap* map) noexcept : node_(node), map_(map) {}
+
+        Ref node_ = 0;
+        const MappedPooledMap* map_ = nullptr;
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    /**
+     * @brief 打开已有文件 / Open an existing file
+     *
+     * 只做 mmap 与文件头校验，O(1)。ReadWrite 方式下文件不存在或为空时新建。
+     * 文件头与 Key / Value 尺寸不符时抛出 std::runtime_error，系统调用失败时抛出 std::system_error。
+     *
+     * Only maps the file and checks its header, O(1). In ReadWrite mode a
+     * missing or empty file is created. Throws std::runtime_error when the
+     * header does not match Key / Value, std::system_error when a system
+     * call fails.
+     */
+    static MappedPooledMap open(const std::string& path, Mode mode = Mode::ReadWrite, const Compare& comp = Compare()) {
+        MappedPooledMap map(comp);
+        map.open_file(path, mode, false, default_initial_bytes);
+        return map;
+    }
+
+    /// 新建（或截断已有的）文件，初始大小 initial_bytes / Create (or truncate) a file of initial_bytes
+    static MappedPooledMap create(const std::string& path, std::size_t initial_bytes = default_initial_bytes,
+                                  const Compare& comp = Compare()) {
+        MappedPooledMap map(comp);
+        map.open_file(path, Mode::ReadWrite, true, initial_bytes);
+        return map;
+    }
+
+    MappedPooledMap(MappedPooledMap&& other) noexcept : comp_(other.comp_) { swap(other); }
+
+    MappedPooledMap& operator=(MappedPooledMap&& other) noexcept {
+        if (this != &other) {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+
+    MappedPooledMap(const MappedPooledMap&) = delete;
+    MappedPooledMap& operator=(const MappedPooledMap&) = delete;
+
+    /// 解除映射并关闭文件；修改已在页缓存中，持久化需先 flush() / Unmap and close; changes sit in the page cache, flush() first for durability
+    ~MappedPooledMap() { close(); }
+
+    void swap(MappedPooledMap& other) noexcept {
+        using std::swap;
+        swap(base_, other.base_);
+        swap(mapped_bytes_, other.mapped_bytes_);
+        swap(fd_, other.fd_);
+        swap(writable_, other.writable_);
+        swap(comp_, other.comp_);
+    }
+
+    friend void swap(MappedPooledMap& a, MappedPooledMap& b) noexcept { a.swap(b); }
+
+    void close() noexcept {
+        if (base_) ::munmap(base_, mapped_bytes_);
+        if (fd_ >= 0) ::close(fd_);
+        base_ = nullptr;
+        mapped_bytes_ = 0;
+        fd_ = -1;
+        writable_ = false;
+    }
+
+    bool is_open() const noexcept { return base_ != nullptr; }
+    bool read_only() const noexcept { return !writable_; }
+
+    /**
+     * @brief 把映射中的修改写回文件 / Write the mapping's changes back to the file
+     *
+     * async 为 false 时等待写盘完成（MS_SYNC），否则只发起写回（MS_ASYNC）。
+     * With async false, waits for the write to complete (MS_SYNC); otherwise
+     * only schedules it (MS_ASYNC).
+     */
+    void flush(bool async = false) {
+        if (base_ && writable_ && ::msync(base_, mapped_bytes_, async ? MS_ASYNC : MS_SYNC) != 0)
+            pooled_detail::throw_errno("MappedPooledMap::flush");
+    }
+
+    std::size_t size() const noexcept { return base_ ? static_cast<std::size_t>(header()->size) : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    /// 文件当前字节数 / Current file size in bytes
+    std::size_t file_bytes() const noexcept { return mapped_bytes_; }
+
+    iterator begin() noexcept { return iterator(first(), this); }
+    const_iterator begin() const noexcept { return const_iterator(first(), this); }
+    iterator end() noexcept { return iterator(0, this); }
+    const_iterator end() const noexcept { return const_iterator(0, this); }
+
+    // ---------- 查找 / Lookup ----------
+
+    template <typename K>
+    iterator find(const K& key) noexcept { return iterator(find_node(key), this); }
+    template <typename K>
+    const_iterator find(const K& key) const noexcept { return const_iterator(find_node(key), this); }
+
+    template <typename K>
+    iterator lower_bound(const K& key) noexcept { return iterator(lower_bound_node(key), this); }
+    template <typename K>
+    const_iterator lower_bound(const K& key) const noexcept { return const_iterator(lower_bound_node(key), this); }
+
+    template <typename K>
+    iterator upper_bound(const K& key) noexcept { return iterator(upper_bound_node(key), this); }
+    template <typename K>
+    const_iterator upper_bound(const K& key) const noexcept { return const_iterator(upper_bound_node(key), this); }
+
+    template <typename K>
+    bool contains(const K& key) const noexcept { return find_node(key) != 0; }
+
+    /// 找不到返回 nullptr；指针在下一次扩展文件后失效 / nullptr when absent; invalidated when the file next grows
+    template <typename K>
+    Value* find_ptr(const K& key) noexcept {
+        Ref n = find_node(key);
+        return n ? &nd(n).value : nullptr;
+    }
+    template <typename K>
+    const Value* find_ptr(const K& key) const noexcept {
+        Ref n = find_node(key);
+        return n ? &nd(n).value : nullptr;
+    }
+
+    /// 中序访问每个元素 func(const Key&, Value&) / Visit every element in order
+    template <typename Func>
+    void for_each(Func&& func) {
+        for (Ref cur = first(); cur; cur = successor(cur)) func(static_cast<const Key&>(nd(cur).key), nd(cur).value);
+    }
+    template <typename Func>
+    void for_each(Func&& func) const {
+        for (Ref cur = first(); cur; cur = successor(cur)) func(nd(cur).key, static_cast<const Value&>(nd(cur).value));
+    }
+
+    // ---------- 修改（仅读写方式）/ Updates (read-write only) ----------
+    //
+    // 只读方式打开时抛出 std::logic_error / Throw std::logic_error when opened read-only
+
+    /// 键不存在时插入，返回 (位置, 是否插入) / Insert when the key is absent; returns (position, inserted)
+    std::pair<iterator, bool> insert(const Key& key, const Value& value) {
+        require_writable();
+        InsertPos pos = find_insert_pos(key);
+        if (pos.match) return { iterator(pos.match, this), false };
+        Ref n = create_node(key, value);
+        link_node(n, pos);
+        return { iterator(n, this), true };
+    }
+
+    /// 插入或覆盖 / Insert or overwrite
+    std::pair<iterator, bool> insert_or_assign(const Key& key, const Value& value) {
+        require_writable();
+        InsertPos pos = find_insert_pos(key);
+        if (pos.match) {
+            nd(pos.match).value = value;
+            return { iterator(pos.match, this), false };
+        }
+        Ref n = create_node(key, value);
+        link_node(n, pos);
+        return { iterator(n, this), true };
+    }
+
+    /// 不存在时插入值初始化的 Value / Inserts a value-initialized Value when absent
+    Value& operator[](const Key& key) { return insert(key, Value()).first.value(); }
+
+    /// 删除 key，返回删除的元素数 / Erase key, returning the number of elements erased
+    template <typename K>
+    std::size_t erase(const K& key) {
+        require_writable();
+        Ref n = find_node(key);
+        if (!n) return 0;
+        unlink_node(n);
+        free_node(n);
+        return 1;
+    }
+
+    /// 删除 pos 处的元素，返回其后继 / Erase the element at pos, returning its successor
+    iterator erase(const_iterator pos) {
+        require_writable();
+        Ref next = successor(pos.node_);
+        unlink_node(pos.node_);
+        free_node(pos.node_);
+        return iterator(next, this);
+    }
+
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    /// 清空全部元素，文件大小不变 / Remove every element; the file keeps its size
+    void clear() {
+        require_writable();
+        pooled_detail::MappedHeader* h = header();
+        h->root = 0;
+        h->size = 0;
+        h->free_head = 0;
+        h->used = data_offset;
+    }
+
+    /// 扩展文件，保证再插入 n 个节点不会重新映射 / Grow the file so n more nodes fit without a remap
+    void reserve(std::size_t n) {
+        require_writable();
+        std::uint64_t need = header()->used + std::uint64_t(n) * sizeof(Node);
+        if (need > mapped_bytes_) grow(need);
+    }
+
+private:
+    // ---------- 内部定义 / Internal definitions ----------
+    enum Color { RED = 0, BLACK = 1 };
+
+    // 节点：链接为文件内偏移，偏移按节点对齐，最低位存颜色 / Links are in-file offsets; they are node-aligned, so the low bit holds the color
+    struct Node {
+        Key key;
+        Value value;
+        Ref left;
+        Ref right;
+        Ref parent_color;
+    };
+
+    static_assert(alignof(Node) >= 2, "MappedPooledMap packs the color into the parent offset's low bit");
+
+    // 节点区起点：文件头之后按节点对齐 / Nodes start after the header, node-aligned
+    static constexpr std::uint64_t data_offset =
+        (sizeof(pooled_detail::MappedHeader) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+
+    unsigned char* base_ = nullptr;   ///< 映射起点 / start of the mapping
+    std::size_t mapped_bytes_ = 0;    ///< 映射长度，等于文件大小 / mapping length, equal to the file size
+    int fd_ = -1;
+    bool writable_ = false;
+    Compare comp_;
+
+    explicit MappedPooledMap(const Compare& comp) : comp_(comp) {}
+
+    pooled_detail::MappedHeader* header() const noexcept { return reinterpret_cast<pooled_detail::MappedHeader*>(base_); }
+    Node& nd(Ref r) const noexcept { return *reinterpret_cast<Node*>(base_ + r); }
+
+    // ---------- 文件与映射 / File and mapping ----------
+
+    void open_file(const std::string& path, Mode mode, bool truncate, std::size_t initial_bytes) {
+        writable_ = (mode == Mode::ReadWrite);
+        int flags = writable_ ? (O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0)) : O_RDONLY;
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0) pooled_detail::throw_errno("MappedPooledMap: open");
+
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) pooled_detail::throw_errno("MappedPooledMap: fstat");
+        std::size_t bytes = static_cast<std::size_t>(st.st_size);
+        bool fresh = (bytes == 0);
+        if (fresh) {
+            if (!writable_) throw std::runtime_error("MappedPooledMap: empty file opened read-only");
+            bytes = round_to_page(std::max<std::size_t>(initial_bytes, data_offset + sizeof(Node)));
+            if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) pooled_detail::throw_errno("MappedPooledMap: ftruncate");
+        } else if (bytes < sizeof(pooled_detail::MappedHeader)) {
+            throw std::runtime_error("MappedPooledMap: file too small for a header");
+        }
+
+        map_file(bytes);
+        if (fresh) {
+            init_header(bytes);
+        } else {
+            check_header();
+            // 补上扩展中断时落后的 capacity / Catch up a capacity left behind by an interrupted growth
+            if (writable_) header()->capacity = mapped_bytes_;
+        }
+    }
+
+    void map_file(std::size_t bytes) {
+        int prot = PROT_READ | (writable_ ? PROT_WRITE : 0);
+        void* p = ::mmap(nullptr, bytes, prot, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) pooled_detail::throw_errno("MappedPooledMap: mmap");
+        base_ = static_cast<unsigned char*>(p);
+        mapped_bytes_ = bytes;
+    }
+
+    void init_header(std::size_t bytes) noexcept {
+        pooled_detail::MappedHeader* h = header();
+        std::memcpy(h->magic, pooled_detail::mapped_magic, sizeof(h->magic));
+        h->version = pooled_detail::mapped_version;
+        h->byte_order = pooled_detail::mapped_byte_order;
+        h->key_size = sizeof(Key);
+        h->key_align = alignof(Key);
+        h->value_size = sizeof(Value);
+        h->value_align = alignof(Value);
+        h->node_size = sizeof(Node);
+        h->root = 0;
+        h->size = 0;
+        h->free_head = 0;
+        h->used = data_offset;
+        h->capacity = bytes;
+    }
+
+    void check_header() const {
+        const pooled_detail::MappedHeader* h = header();
+        if (std::memcmp(h->magic, pooled_detail::mapped_magic, sizeof(h->magic)) != 0)
+            throw std::runtime_error("MappedPooledMap: not a mapped map file");
+        if (h->version != pooled_detail::mapped_version || h->byte_order != pooled_detail::mapped_byte_order)
+            throw std::runtime_error("MappedPooledMap: unsupported file version or byte order");
+        if (h->key_size != sizeof(Key) || h->key_align != alignof(Key) || h->value_size != sizeof(Value) ||
+            h->value_align != alignof(Value) || h->node_size != sizeof(Node))
+            throw std::runtime_error("MappedPooledMap: file was written with different Key / Value types");
+        // 头部可以落后于加长的文件，反之不行；节点只在 used 以内 / The header may lag a longer file, never the reverse; nodes live below used
+        if (h->capacity > mapped_bytes_ || h->used > h->capacity || h->used < data_offset)
+            throw std::runtime_error("MappedPooledMap: file size does not match its header");
+    }
+
+    static std::size_t round_to_page(std::size_t bytes) noexcept {
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        return (bytes + page - 1) / page * page;
+    }
+
+    // 按倍增扩展文件并重新映射；先建新映射再拆旧映射，失败时原映射不变。
+    // 先加长文件、最后写 capacity，头部只会落后于文件（见类说明）
+    // Grow the file by doubling and remap; the new mapping is made before the
+    // old one goes, so a failure leaves the old mapping in place. The file is
+    // lengthened first and capacity written last, so the header can only lag
+    // the file (see the class comment)
+    void grow(std::uint64_t min_bytes) {
+        std::size_t bytes = round_to_page(static_cast<std::size_t>(std::max<std::uint64_t>(min_bytes, std::uint64_t(mapped_bytes_) * 2)));
+        if (::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) pooled_detail::throw_errno("MappedPooledMap: ftruncate");
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            // 文件截回原长，不留下用不上的尾部 / Truncate back rather than leave an unused tail
+            int err = errno;
+            (void)::ftruncate(fd_, static_cast<off_t>(mapped_bytes_));
+            errno = err;
+            pooled_detail::throw_errno("MappedPooledMap: mmap");
+        }
+        ::munmap(base_, mapped_bytes_);
+        base_ = static_cast<unsigned char*>(p);
+        mapped_bytes_ = bytes;
+        header()->capacity = bytes;
+    }
+
+    void require_writable() const {
+        if (!base_) throw std::logic_error("MappedPooledMap is not open");
+        if (!writable_) throw std::logic_error("MappedPooledMap opened read-only");
+    }
+
+    // ---------- 节点分配：文件内空闲链 + 顺序切分 / Node allocation: in-file free list + bump carving ----------
+
+    // 参数按值传入：引用可能指向映射内部，grow() 拆除旧映射后即失效
+    // Arguments are taken by value: a reference may point into the mapping,
+    // which grow() unmaps
+    Ref create_node(Key key, Value value) {
+        pooled_detail::MappedHeader* h = header();
+        Ref r = h->free_head;
+        if (r) {
+            h->free_head = nd(r).left;
+        } else {
+            if (h->used + sizeof(Node) > mapped_bytes_) {
+                grow(h->used + sizeof(Node));
+                h = header();
+            }
+            r = h->used;
+            h->used += sizeof(Node);
+        }
+        ::new (static_cast<void*>(base_ + r)) Node{ key, value, 0, 0, 0 };
+        return r;
+    }
+
+    // 空闲链经 left 串联 / The free list chains through left
+    void free_node(Ref r) noexcept {
+        pooled_detail::MappedHeader* h = header();
+        nd(r).left = h->free_head;
+        h->free_head = r;
+    }
+
+    // ---------- 链接访问 / Link access ----------
+
+    Ref parent(Ref n) const noexcept { return nd(n).parent_color & ~Ref(1); }
+    void set_parent(Ref n, Ref p) noexcept { nd(n).parent_color = p | (nd(n).parent_color & Ref(1)); }
+    Color color(Ref n) const noexcept { return static_cast<Color>(nd(n).parent_color & Ref(1)); }
+    void set_color(Ref n, Color c) noexcept { nd(n).parent_color = (nd(n).parent_color & ~Ref(1)) | Ref(c); }
+    bool is_black(Ref n) const noexcept { return !n || color(n) == BLACK; }
+
+    Ref first() const noexcept {
+        Ref root = base_ ? header()->root : 0;
+        return root ? minimum(root) : 0;
+    }
+
+    Ref minimum(Ref n) const noexcept {
+        while (nd(n).left) n = nd(n).left;
+        return n;
+    }
+    Ref maximum(Ref n) const noexcept {
+        while (nd(n).right) n = nd(n).right;
+        return n;
+    }
+    Ref successor(Ref n) const noexcept {
+        if (nd(n).right) return minimum(nd(n).right);
+        Ref p = parent(n);
+        while (p && n == nd(p).right) {
+            n = p;
+            p = parent(p);
+        }
+        return p;
+    }
+    Ref predecessor(Ref n) const noexcept {
+        if (nd(n).left) return maximum(nd(n).left);
+        Ref p = parent(n);
+        while (p && n == nd(p).left) {
+            n = p;
+            p = parent(p);
+        }
+        return p;
+    }
+
+    // p 中指向 old 的链接改为 fresh，p 为空时改根 / Repoint p's link from old to fresh, the root when p is none
+    void replace_child(Ref p, Ref old, Ref fresh) noexcept {
+        if (!p) header()->root = fresh;
+        else if (nd(p).left == old) nd(p).left = fresh;
+        else nd(p).right = fresh;
+    }
+
+    // ---------- 红黑树内部操作，同 PooledMap / Red-black tree internals, as in PooledMap ----------
+
+    void rotate_left(Ref x) noexcept {
+        Ref y = nd(x).right;
+        nd(x).right = nd(y).left;
+        if (nd(y).left) set_parent(nd(y).left, x);
+        set_parent(y, parent(x));
+        replace_child(parent(x), x, y);
+        nd(y).left = x;
+        set_parent(x, y);
+    }
+
+    void rotate_right(Ref x) noexcept {
+        Ref y = nd(x).left;
+        nd(x).left = nd(y).right;
+        if (nd(y).right) set_parent(nd(y).right, x);
+        set_parent(y, parent(x));
+        replace_child(parent(x), x, y);
+        nd(y).right = x;
+        set_parent(x, y);
+    }
+
+    void fix_insert(Ref z) noexcept {
+        while (parent(z) && color(parent(z)) == RED) {
+            Ref p = parent(z);
+            Ref g = parent(p);
+            if (p == nd(g).left) {
+                Ref y = nd(g).right;
+                if (y && color(y) == RED) {
+                    // Case 1: 叔叔为红色 / Uncle is red
+                    set_color(p, BLACK);
+                    set_color(y, BLACK);
+                    set_color(g, RED);
+                    z = g;
+                } else {
+                    if (z == nd(p).right) {
+                        // Case 2: 内旋转 / Inner rotation
+                        z = p;
+                        rotate_left(z);
+                    }
+                    // Case 3: 外旋转 / Outer rotation
+                    set_color(parent(z), BLACK);
+                    set_color(parent(parent(z)), RED);
+                    rotate_right(parent(parent(z)));
+                }
+            } else {
+                Ref y = nd(g).left;
+                if (y && color(y) == RED) {
+                    set_color(p, BLACK);
+                    set_color(y, BLACK);
+                    set_color(g, RED);
+                    z = g;
+                } else {
+                    if (z == nd(p).left) {
+                        z = p;
+                        rotate_right(z);
+                    }
+                    set_color(parent(z), BLACK);
+                    set_color(parent(parent(z)), RED);
+                    rotate_left(parent(parent(z)));
+                }
+            }
+        }
+        set_color(header()->root, BLACK);
+    }
+
+    void fix_erase(Ref x, Ref x_parent) noexcept {
+        while (x != header()->root && is_black(x)) {
+            if (x == nd(x_parent).left) {
+                Ref w = nd(x_parent).right;
+                if (w && color(w) == RED) {
+                    // Case 1: 兄弟为红色 / Sibling is red
+                    set_color(w, BLACK);
+                    set_color(x_parent, RED);
+                    rotate_left(x_parent);
+                    w = nd(x_parent).right;
+                }
+                if (is_black(nd(w).left) && is_black(nd(w).right)) {
+                    // Case 2: 两个子节点都是黑色 / Both children black
+                    set_color(w, RED);
+                    x = x_parent;
+                    x_parent = parent(x);
+                } else {
+                    if (is_black(nd(w).right)) {
+                        if (nd(w).left) set_color(nd(w).left, BLACK);
+                        set_color(w, RED);
+                        rotate_right(w);
+                        w = nd(x_parent).right;
+                    }
+                    // Case 3: 修复并旋转 / Fix and rotate
+                    set_color(w, color(x_parent));
+                    set_color(x_parent, BLACK);
+                    if (nd(w).right) set_color(nd(w).right, BLACK);
+                    rotate_left(x_parent);
+                    x = header()->root;
+                }
+            } else {
+                Ref w = nd(x_parent).left;
+                if (w && color(w) == RED) {
+                    set_color(w, BLACK);
+                    set_color(x_parent, RED);
+                    rotate_right(x_parent);
+                    w = nd(x_parent).left;
+                }
+                if (is_black(nd(w).right) && is_black(nd(w).left)) {
+                    set_color(w, RED);
+                    x = x_parent;
+                    x_parent = parent(x);
+                } else {
+                    if (is_black(nd(w).left)) {
+                        if (nd(w).right) set_color(nd(w).right, BLACK);
+                        set_color(w, RED);
+                        rotate_left(w);
+                        w = nd(x_parent).left;
+                    }
+                    set_color(w, color(x_parent));
+                    set_color(x_parent, BLACK);
+                    if (nd(w).left) set_color(nd(w).left, BLACK);
+                    rotate_right(x_parent);
+                    x = header()->root;
+                }
+            }
+        }
+        if (x) set_color(x, BLACK);
+    }
+
+    // 用 v 顶替 u 的位置 / v takes u's place
+    void transplant(Ref u, Ref v) noexcept {
+        replace_child(parent(u), u, v);
+        if (v) set_parent(v, parent(u));
+    }
+
+    void unlink_node(Ref z) noexcept {
+        Ref y = z;
+        Color y_original_color = color(y);
+        Ref x = 0;
+        Ref x_parent = 0;
+
+        if (!nd(z).left) {
+            x = nd(z).right;
+            x_parent = parent(z);
+            transplant(z, nd(z).right);
+        } else if (!nd(z).right) {
+            x = nd(z).left;
+            x_parent = parent(z);
+            transplant(z, nd(z).left);
+        } else {
+            y = minimum(nd(z).right);
+            y_original_color = color(y);
+            x = nd(y).right;
+            if (parent(y) == z) {
+                if (x) set_parent(x, y);
+                x_parent = y;
+            } else {
+                transplant(y, nd(y).right);
+                nd(y).right = nd(z).right;
+                set_parent(nd(y).right, y);
+                x_parent = parent(y);
+            }
+            transplant(z, y);
+            nd(y).left = nd(z).left;
+            set_parent(nd(y).left, y);
+            set_color(y, color(z));
+        }
+
+        --header()->size;
+
+        if (y_original_color == BLACK)
+            fix_erase(x, x_parent);
+    }
+
+    // ---------- 查找与插入，每层一次比较 / Lookup and insertion, one comparison per level ----------
+
+    template <typename K>
+    Ref lower_bound_node(const K& key) const {
+        Ref cur = base_ ? header()->root : 0;
+        Ref result = 0;
+        while (cur) {
+            if (comp_(nd(cur).key, key)) cur = nd(cur).right;
+            else { result = cur; cur = nd(cur).left; }
+        }
+        return result;
+    }
+
+    template <typename K>
+    Ref upper_bound_node(const K& key) const {
+        Ref cur = base_ ? header()->root : 0;
+        Ref result = 0;
+        while (cur) {
+            if (comp_(key, nd(cur).key)) { result = cur; cur = nd(cur).left; }
+            else cur = nd(cur).right;
+        }
+        return result;
+    }
+
+    template <typename K>
+    Ref find_node(const K& key) const {
+        Ref n = lower_bound_node(key);
+        return (n && !comp_(key, nd(n).key)) ? n : 0;
+    }
+
+    // 插入位置：命中时 match 非空 / Insertion slot; match is set on a hit
+    struct InsertPos {
+        Ref parent;
+        Ref match;
+        bool left;
+    };
+
+    template <typename K>
+    InsertPos find_insert_pos(const K& key) const {
+        Ref cur = header()->root;
+        Ref parent = 0;
+        Ref candidate = 0;
+        bool go_left = false;
+        while (cur) {
+            parent = cur;
+            go_left = !comp_(nd(cur).key, key);
+            if (go_left) { candidate = cur; cur = nd(cur).left; }
+            else cur = nd(cur).right;
+        }
+        if (candidate && !comp_(key, nd(candidate).key)) return { parent, candidate, go_left };
+        return { parent, 0, go_left };
+    }
+
+    // 位置以偏移记录，create_node 扩展文件后仍然有效 / The slot is offsets, so it survives create_node growing the file
+    void link_node(Ref n, const InsertPos& pos) noexcept {
+        nd(n).left = nd(n).right = 0;
+        nd(n).parent_color = pos.parent | Ref(RED);
+        if (!pos.parent) header()->root = n;
+        else if (pos.left) nd(pos.parent).left = n;
+        else nd(pos.parent).right = n;
+        fix_insert(n);
+        ++header()->size;
+    }
+};
@@ -0,0 +1,510 @@
+//
+//  PersistentPooledMap.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  PersistentPooledMap 功能介绍 / Features
+//  -----------------------------------------------------------------------------
+//
+//  支持 O(1) 快照的写时复制有序映射：
+//  1. 节点带引用计数，可被多棵树共享；snapshot() 只给根节点加一次引用。
+//  2. 修改沿路径复制 (path copying)：路径上被共享的节点复制一份再改，
+//     只属于当前树的节点（引用计数为 1）原地修改，没有快照时开销接近普通平衡树。
+//  3. 快照是不可变视图，可交给其他线程读取或序列化，写者继续修改也不会影响它，
+//     没有任何全局停顿；最后一个引用释放时节点 recycle 回对象池。
+//
+//  A copy-on-write ordered map with O(1) snapshots:
+//  1. Nodes are reference counted and may be shared by several trees;
+//     snapshot() only adds one reference to the root.
+//  2. Updates copy the path: shared nodes on the path are copied before they
+//     change, while nodes owned by this tree alone (count 1) are updated in
+//     place, so without snapshots it costs about the same as a plain balanced tree.
+//  3. A snapshot is an immutable view that can be read or serialized on
+//     another thread while the writer keeps mutating, with no stop-the-world
+//     pause. Nodes go back to the pool when their last reference is dropped.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "PoolPolicy.hpp"
+
+/**
+ * @brief 可 O(1) 快照的持久化有序映射 / Persistent ordered map with O(1) snapshots
+ *
+ * 内部为按路径复制的 AVL 树：树高上限更紧（约 1.44·log2 n），
+ * 递归下降与复制路径都短；持久化删除也比红黑树简单得多。
+ * 本容器本身只允许单个写者；快照可在任意线程读取与释放，
+ * 释放时回收节点，因此跨线程释放快照需要 Pool 策略支持（如 ThreadLocalPoolPolicy）。
+ *
+ * A path-copying AVL tree: its tighter height bound (about 1.44·log2 n)
+ * keeps both the recursive descent and the copied path short, and
+ * persistent deletion is far simpler than for a red-black tree.
+ * The map itself takes a single writer; snapshots may be read and released
+ * on any thread. Releasing one recycles nodes, so releasing snapshots on
+ * another thread needs a Pool policy that allows it (e.g. ThreadLocalPoolPolicy).
+ *
+ * @tparam Compare 键比较器，默认 std::less<>（透明，支持异构查找）/
+ *                 Key comparator; defaults to std::less<> (transparent, enables heterogeneous lookup).
+ * @tparam Pool    节点池策略，见 PoolPolicy.hpp / Node pool policy, see PoolPolicy.hpp.
+ */
+template <typename Key, typename Value, typename Compare = std::less<>, typename Pool = SegmentedPoolPolicy>
+class PersistentPooledMap {
+    struct Node;
+    using NodeType = Node;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = std::size_t;
+    using key_compare = Compare;
+    using pool_type = Pool;
+
+    /**
+     * @brief 不可变快照 / Immutable snapshot
+     *
+     * 拷贝快照只增加根节点引用计数，O(1)。
+     * Copying a snapshot only bumps the root's reference count: O(1).
+     */
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        Snapshot(const Snapshot& other) noexcept
+            : root_(retain(other.root_)), size_(other.size_), comp_(other.comp_), pool_(other.pool_) {}
+
+        Snapshot(Snapshot&& other) noexcept
+            : root_(other.root_), size_(other.size_), comp_(other.comp_), pool_(other.pool_) {
+            other.root_ = nullptr;
+            other.size_ = 0;
+        }
+
+        Snapshot& operator=(Snapshot other) noexcept {
+            std::swap(root_, other.root_);
+            std::swap(size_, other.size_);
+            std::swap(comp_, other.comp_);
+            std::swap(pool_, other.pool_);
+            return *this;
+        }
+
+        ~Snapshot() { release(root_, pool_); }
+
+        std::size_t size() const noexcept { return size_; }
+        bool empty() const noexcept { return size_ == 0; }
+
+        /// 查找，未命中返回 nullptr / Find, or nullptr on a miss
+        const Value* find_ptr(const Key& key) const { return value_of(find_node(root_, key, comp_)); }
+
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        const Value* find_ptr(const K& key) const { return value_of(find_node(root_, key, comp_)); }
+
+        bool contains(const Key& key) const { return find_node(root_, key, comp_) != nullptr; }
+
+        template <typename K, typename C = Compare, typename = typename C::is_transparent>
+        bool contains(const K& key) const { return find_node(root_, key, comp_) != nullptr; }
+
+        template <typename Func>
+        bool try_get(const Key& key, Func&& func) const { return visit_node(find_node(root_, key, comp_), func); }
+
+        template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+        bool try_get(const K& key, Func&& func) const { return visit_node(find_node(root_, key, comp_), func); }
+
+        /// 按升序遍历 / In-order traversal
+        template <typename Func>
+        void for_each(Func&& func) const { inorder_traverse(root_, func); }
+
+    private:
+        friend class PersistentPooledMap;
+
+        Snapshot(NodeType* root, std::size_t size, const Compare& comp, const Pool& pool) noexcept
+            : root_(root), size_(size), comp_(comp), pool_(pool) {}
+
+        NodeType* root_ = nullptr;
+        std::size_t size_ = 0;
+        Compare comp_;
+        Pool pool_;
+    };
+
+    PersistentPooledMap() = default;
+    explicit PersistentPooledMap(const Compare& comp, const Pool& pool = Pool()) : comp_(comp), pool_(pool) {}
+    explicit PersistentPooledMap(const Pool& pool) : pool_(pool) {}
+
+    /// 从快照恢复出可写的映射，O(1) / Make a writable map from a snapshot, O(1)
+    explicit PersistentPooledMap(const Snapshot& snap)
+        : root_(retain(snap.root_)), size_(snap.size_), comp_(snap.comp_), pool_(snap.pool_) {}
+
+    /// 拷贝只共享根节点，O(1)；之后两边各自按需复制路径 / Copy shares the root, O(1); each side copies paths as it changes
+    PersistentPooledMap(const PersistentPooledMap& other)
+        : root_(retain(other.root_)), size_(other.size_), comp_(other.comp_), pool_(other.pool_) {}
+
+    PersistentPooledMap(PersistentPooledMap&& other) noexcept
+        : root_(other.root_), size_(other.size_), comp_(other.comp_), pool_(other.pool_) {
+        other.root_ = nullptr;
+        other.size_ = 0;
+    }
+
+    PersistentPooledMap& operator=(PersistentPooledMap other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(size_, other.size_);
+        std::swap(comp_, other.comp_);
+        std::swap(pool_, other.pool_);
+        return *this;
+    }
+
+    ~PersistentPooledMap() { release(root_, pool_); }
+
+    /**
+     * @brief O(1) 快照 / O(1) snapshot
+     *
+     * 返回当前内容的不可变视图；此后对本映射的修改不会反映到快照中。
+     * Returns an immutable view of the current contents; later changes to
+     * this map are not visible through it.
+     */
+    Snapshot snapshot() const noexcept { return Snapshot(retain(root_), size_, comp_, pool_); }
+
+    // ---------- 查找 / Lookup ----------
+
+    /// 查找，未命中返回 nullptr / Find, or nullptr on a miss
+    const Value* find_ptr(const Key& key) const { return value_of(find_node(root_, key, comp_)); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const Value* find_ptr(const K& key) const { return value_of(find_node(root_, key, comp_)); }
+
+    bool contains(const Key& key) const { return find_node(root_, key, comp_) != nullptr; }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const { return find_node(root_, key, comp_) != nullptr; }
+
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) const { return visit_node(find_node(root_, key, comp_), func); }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) const { return visit_node(find_node(root_, key, comp_), func); }
+
+    /// 按升序遍历 / In-order traversal
+    template <typename Func>
+    void for_each(Func&& func) const { inorder_traverse(root_, func); }
+
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+    Compare key_comp() const { return comp_; }
+    const Pool& get_pool() const noexcept { return pool_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    /// 节点池统计，见 PoolStats.hpp / Node pool statistics, see PoolStats.hpp
+    PoolStats pool_stats() const { return pool_.template stats<NodeType>(); }
+#endif
+
+    // ---------- 修改 / Modification ----------
+
+    /**
+     * @brief key 不存在时才原位构造 value / Construct the value in place only if key is absent
+     *
+     * 命中时不复制路径，也不消耗参数。返回 true 表示发生了插入。
+     * A hit copies no path and leaves the arguments untouched. Returns true
+     * when an insertion happened.
+     */
+    template <typename... Args>
+    bool try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    bool try_emplace(Key&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 插入或赋值 / Insert, or assign to the existing value
+     *
+     * 返回 true 表示发生了插入。Returns true when an insertion happened.
+     */
+    template <typename M>
+    bool insert_or_assign(const Key& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    bool insert_or_assign(Key&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+    }
+
+    /// 删除 key，返回删除的元素个数 / Erase key, returning the number of elements removed
+    std::size_t erase(const Key& key) { return erase_impl(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t erase(const K& key) { return erase_impl(key); }
+
+    /// 清空；仍被快照共享的节点保留到快照释放 / Clear; nodes still shared with snapshots live until those are released
+    void clear() noexcept {
+        release(root_, pool_);
+        root_ = nullptr;
+        size_ = 0;
+    }
+
+private:
+    // ---------- 内部定义 / Internal definitions ----------
+
+    /**
+     * @brief 引用计数的 AVL 节点 / Reference-counted AVL node
+     *
+     * refs 为指向本节点的父节点与根的个数；为 1 时节点只属于一棵树，可原地修改。
+     * refs counts the parents and roots pointing at this node; at 1 the node
+     * belongs to a single tree and may be changed in place.
+     */
+    struct Node : public Pool::template node_base<Node> {
+        Key key;
+        Value value;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        std::atomic<std::uint32_t> refs{1};
+        std::uint8_t height = 1;
+
+        template <typename KArgs, typename VArgs>
+        Node(std::piecewise_construct_t, KArgs&& kargs, VArgs&& vargs)
+            : key(std::make_from_tuple<Key>(std::forward<KArgs>(kargs))),
+              value(std::make_from_tuple<Value>(std::forward<VArgs>(vargs))) {}
+
+        // 路径复制：拷贝内容并共享两个子树 / Path copy: copy the contents and share both subtrees
+        explicit Node(const Node& other)
+            : key(other.key), value(other.value), left(retain(other.left)), right(retain(other.right)),
+              height(other.height) {}
+    };
+
+    NodeType* root_ = nullptr;     ///< 根节点 / Root node
+    std::size_t size_ = 0;         ///< 节点数量 / Number of nodes
+    Compare comp_;                 ///< 键比较器 / Key comparator
+    Pool pool_;                    ///< 节点池策略 / Node pool policy
+
+    // ---------- 引用计数 / Reference counting ----------
+
+    static NodeType* retain(NodeType* node) noexcept {
+        if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+        return node;
+    }
+
+    // 去掉一个引用，归零时回收并递归释放子树；递归深度不超过树高
+    // Drop one reference; at zero recycle the node and release its subtrees.
+    // Recursion depth is bounded by the tree height.
+    static void release(NodeType* node, const Pool& pool) noexcept {
+        while (node) {
+            if (node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+            NodeType* right = node->right;
+            release(node->left, pool);
+            pool.recycle(node);
+            node = right;
+        }
+    }
+
+    // 确保 slot 指向只属于本树的节点，必要时复制 / Make slot point at a node owned by this tree alone, copying if needed
+    NodeType* own(NodeType*& slot) {
+        NodeType* node = slot;
+        if (node->refs.load(std::memory_order_acquire) != 1) {
+            NodeType* copy = pool_.template create<NodeType>(*node);
+            release(node, pool_);
+            slot = node = copy;
+        }
+        return node;
+    }
+
+    // ---------- 查找 / Lookup ----------
+
+    template <typename K>
+    static NodeType* find_node(NodeType* cur, const K& key, const Compare& comp) {
+        NodeType* candidate = nullptr;
+        while (cur) {
+            if (comp(cur->key, key)) cur = cur->right;
+            else { candidate = cur; cur = cur->left; }
+        }
+        return (candidate && !comp(key, candidate->key)) ? candidate : nullptr;
+    }
+
+    static const Value* value_of(const NodeType* node) noexcept { return node ? &node->value : nullptr; }
+
+    template <typename Func>
+    static bool visit_node(const NodeType* node, Func& func) {
+        if (!node) return false;
+        func(node->value);
+        return true;
+    }
+
+    template <typename Func>
+    static void inorder_traverse(const NodeType* node, Func& func) {
+        while (node) {
+            inorder_traverse(node->left, func);
+            func(node->key, node->value);
+            node = node->right;
+        }
+    }
+
+    // ---------- AVL 平衡 / AVL balancing ----------
+    //
+    // 所有函数都只修改已经 own() 过的节点。
+    // Every function only mutates nodes that have been through own().
+
+    static int height(const NodeType* n) noexcept { return n ? n->height : 0; }
+
+    static void update_height(NodeType* n) noexcept {
+        n->height = static_cast<std::uint8_t>(1 + std::max(height(n->left), height(n->right)));
+    }
+
+    // 右旋，t 已独占 / Right rotation; t is already owned
+    NodeType* rotate_right(NodeType* t) {
+        NodeType* l = own(t->left);
+        t->left = l->right;
+        l->right = t;
+        update_height(t);
+        update_height(l);
+        return l;
+    }
+
+    // 左旋，t 已独占 / Left rotation; t is already owned
+    NodeType* rotate_left(NodeType* t) {
+        NodeType* r = own(t->right);
+        t->right = r->left;
+        r->left = t;
+        update_height(t);
+        update_height(r);
+        return r;
+    }
+
+    // 恢复 t 处的平衡，返回新的子树根 / Restore balance at t and return the new subtree root
+    NodeType* rebalance(NodeType* t) {
+        update_height(t);
+        int bf = height(t->left) - height(t->right);
+        if (bf > 1) {
+            NodeType* l = t->left;
+            if (height(l->left) < height(l->right)) t->left = rotate_left(own(t->left));
+            return rotate_right(t);
+        }
+        if (bf < -1) {
+            NodeType* r = t->right;
+            if (height(r->right) < height(r->left)) t->right = rotate_right(own(t->right));
+            return rotate_left(t);
+        }
+        return t;
+    }
+
+    // ---------- 插入与删除 / Insertion and removal ----------
+
+    // make() 仅在未命中时调用；on_hit(node) 在已独占的命中节点上调用
+    // make() only runs on a miss; on_hit(node) runs on the owned matching node.
+    template <typename K, typename Make, typename OnHit>
+    bool insert_at(NodeType*& slot, const K& key, Make& make, OnHit& on_hit) {
+        if (!slot) {
+            slot = make();
+            return true;
+        }
+        NodeType* t = own(slot);
+        bool inserted;
+        if (comp_(key, t->key)) inserted = insert_at(t->left, key, make, on_hit);
+        else if (comp_(t->key, key)) inserted = insert_at(t->right, key, make, on_hit);
+        else {
+            on_hit(t);
+            return false;
+        }
+        slot = rebalance(t);
+        return inserted;
+    }
+
+    // 摘下子树中的最小节点（已独占，right 置空）/ Detach the minimum node of a subtree (owned, right cleared)
+    NodeType* take_min(NodeType*& slot) {
+        NodeType* t = own(slot);
+        if (!t->left) {
+            slot = t->right;
+            t->right = nullptr;
+            return t;
+        }
+        NodeType* m = take_min(t->left);
+        slot = rebalance(t);
+        return m;
+    }
+
+    template <typename K>
+    void erase_at(NodeType*& slot, const K& key) {
+        NodeType* t = own(slot);
+        if (comp_(key, t->key)) erase_at(t->left, key);
+        else if (comp_(t->key, key)) erase_at(t->right, key);
+        else {
+            // t 已独占，引用计数为 1：子树引用转交给替代节点后直接回收
+            // t is owned (count 1): its subtree references move to the
+            // replacement, then t itself is recycled directly.
+            NodeType* replacement;
+            if (!t->left) replacement = t->right;
+            else if (!t->right) replacement = t->left;
+            else {
+                NodeType* right = t->right;
+                NodeType* m = take_min(right);
+                m->left = t->left;
+                m->right = right;
+                replacement = rebalance(m);
+            }
+            pool_.recycle(t);
+            slot = replacement;
+            return;
+        }
+        slot = rebalance(t);
+    }
+
+    template <typename K, typename... Args>
+    bool try_emplace_impl(K&& key, Args&&... args) {
+        if (find_node(root_, key, comp_)) return false;
+        auto make = [&] {
+            return pool_.template create<NodeType>(std::piecewise_construct,
+                                                   std::forward_as_tuple(std::forward<K>(key)),
+                                                   std::forward_as_tuple(std::forward<Args>(args)...));
+        };
+        auto on_hit = [](NodeType*) {};
+        insert_at(root_, key, make, on_hit);
+        ++size_;
+        return true;
+    }
+
+    template <typename K, typename M>
+    bool insert_or_assign_impl(K&& key, M&& obj) {
+        auto make = [&] {
+            return pool_.template create<NodeType>(std::piecewise_construct,
+                                                   std::forward_as_tuple(std::forward<K>(key)),
+                                                   std::forward_as_tuple(std::forward<M>(obj)));
+        };
+        auto on_hit = [&](NodeType* node) { node->value = std::forward<M>(obj); };
+        bool inserted = insert_at(root_, key, make, on_hit);
+        if (inserted) ++size_;
+        return inserted;
+    }
+
+    template <typename K>
+    std::size_t erase_impl(const K& key) {
+        if (!find_node(root_, key, comp_)) return 0;
+        erase_at(root_, key);
+        --size_;
+        return 1;
+    }
+};
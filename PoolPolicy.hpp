@@ -0,0 +1,1070 @@
+//
+//  PoolPolicy.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  节点池策略 / Node pool policies
+//  -----------------------------------------------------------------------------
+//
+//  PooledMap / PooledList 通过 Pool 模板参数选择节点的分配方式：
+//  1. SegmentedPoolPolicy（默认）：同类型节点共用 PooledObject<Node> 分段对象池。
+//  2. ThreadLocalPoolPolicy：每个线程拥有独立的节点缓存，分配与本线程释放无锁、无竞争；
+//     在其他线程释放的节点经无锁栈归还给所属线程。
+//  3. ArenaPoolPolicy：节点来自调用方传入的 NodeArena，一个会话一个 arena，
+//     节点连续存放，整个 arena 可 O(段数) 一次释放。
+//  4. AllocatorPoolPolicy<Alloc>：使用任意符合标准的分配器（如 std::pmr::polymorphic_allocator）。
+//
+//  PooledMap / PooledList pick how nodes are allocated through the Pool
+//  template parameter:
+//  1. SegmentedPoolPolicy (default): all nodes of one type share the
+//     PooledObject<Node> segmented object pool.
+//  2. ThreadLocalPoolPolicy: every thread owns its node cache, so allocation
+//     and same-thread release take no lock and never contend; nodes released
+//     on another thread go back to their owner through a lock-free stack.
+//  3. ArenaPoolPolicy: nodes come from a caller-supplied NodeArena, e.g. one
+//     arena per session, so nodes stay contiguous and the whole arena can be
+//     released at once in O(segments).
+//  4. AllocatorPoolPolicy<Alloc>: any standard-conforming allocator, such as
+//     std::pmr::polymorphic_allocator.
+//
+//  策略接口 / Policy interface:
+//      template <class Node> using node_base = ...;          // 节点基类 / node base class
+//      template <class Node, class... Args> Node* create(Args&&...);
+//      template <class Node> void recycle(Node*);
+//      static constexpr bool bulk_release;                    // 可选 / optional
+//      static constexpr bool concurrent_create;               // 可选：多线程可同时 create / optional: create may run on several threads at once
+//      template <class Node> void discard(Node*);            // bulk_release 时必需 / required with bulk_release
+//      template <class Node> void reserve(std::size_t n);     // 可选：预留 n 个节点 / optional: reserve n nodes
+//      template <class Node> std::size_t trim();             // 可选：归还完全空闲的段 / optional: free fully free segments
+//      template <class Node> void order_free_list();         // 可选：空闲槽按地址排序 / optional: sort free slots by address
+//      bool operator==(const Policy&, const Policy&);         // 可互相回收节点时相等 / equal when each can recycle the other's nodes
+//
+//  定义 POOLED_CONTAINER_STATS 时另需 / With POOLED_CONTAINER_STATS also:
+//      template <class Node> PoolStats stats() const;         // 见 PoolStats.hpp / see PoolStats.hpp
+//      template <class A, class B> static constexpr bool shared_stats;  // 可选：stats<A>() 与 stats<B>() 计的是同一批节点 / optional: stats<A>() and stats<B>() count the same nodes
+//
+//  bulk_release 为 true 时，节点内存随池整体释放，容器的 release_all()
+//  只需析构元素（平凡析构时什么也不做），不必逐个归还节点。
+//  With bulk_release, node memory is reclaimed together with the pool, so a
+//  container's release_all() only runs element destructors (nothing at all
+//  when they are trivial) instead of returning nodes one by one.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "SegmentedObjectPool.hpp"
+#include "PoolStats.hpp"
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+/// 不依赖共享对象池的节点基类 / Node base for policies that do not use the shared pool
+struct PlainNodeBase {};
+
+/**
+ * @brief 段分配选项 / Segment allocation options
+ *
+ * 供 ThreadLocalPoolPolicy::configure 与 NodeArena 使用；为 0 的字段取各池的默认值。
+ * - populate：新段在分配时即缺页（Linux 上为 MAP_POPULATE，其他平台逐页写入），
+ *   避免首次写入节点时的缺页停顿。
+ * - huge_pages：Linux 上以 mmap 分配并提示内核使用透明大页（MADV_HUGEPAGE），其他平台忽略。
+ *
+ * Used by ThreadLocalPoolPolicy::configure and NodeArena; zero fields take
+ * each pool's default.
+ * - populate: new segments are faulted in when allocated (MAP_POPULATE on
+ *   Linux, a write per page elsewhere), so the first write to a node never
+ *   stalls on a page fault.
+ * - huge_pages: on Linux segments come from mmap with a transparent huge
+ *   page hint (MADV_HUGEPAGE); ignored elsewhere.
+ */
+struct SegmentOptions {
+    std::size_t initial_bytes = 0;  ///< 首段字节数 / bytes of the first segment
+    std::size_t max_bytes = 0;      ///< 单段上限 / cap on one segment
+    std::size_t growth_factor = 0;  ///< 相邻两段的倍数 / size ratio of consecutive segments
+    bool populate = false;
+    bool huge_pages = false;
+};
+
+/**
+ * @brief 默认策略：类型级共享分段对象池 / Default: the type-level shared segmented pool
+ *
+ * 节点继承 PooledObject<Node>，通过 Node::create / recycle 分配与回收。
+ * 线程安全性取决于 SegmentedObjectPool 本身。
+ *
+ * Nodes derive from PooledObject<Node> and go through Node::create / recycle.
+ * Thread safety is whatever SegmentedObjectPool itself provides.
+ */
+struct SegmentedPoolPolicy {
+    template <typename Node>
+    using node_base = PooledObject<Node>;
+
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) const {
+        Node* node = Node::create(std::forward<Args>(args)...);
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<pooled_detail::StatTag<SegmentedPoolPolicy, Node>>::on_create();
+#endif
+        return node;
+    }
+
+    template <typename Node>
+    void recycle(Node* node) const {
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<pooled_detail::StatTag<SegmentedPoolPolicy, Node>>::on_recycle();
+#endif
+        node->recycle();
+    }
+
+#ifdef POOLED_CONTAINER_STATS
+    // 分段池内部不在本仓库内，只报告计数 / The segmented pool's internals live elsewhere; counters only
+    template <typename Node>
+    PoolStats stats() const {
+        return pooled_detail::StatCounters<pooled_detail::StatTag<SegmentedPoolPolicy, Node>>::snapshot();
+    }
+#endif
+
+    // 无状态：任意两个实例可互相回收对方的节点 / Stateless: any instance may recycle another's nodes
+    friend constexpr bool operator==(const SegmentedPoolPolicy&, const SegmentedPoolPolicy&) noexcept { return true; }
+    friend constexpr bool operator!=(const SegmentedPoolPolicy&, const SegmentedPoolPolicy&) noexcept { return false; }
+};
+
+namespace pooled_detail {
+
+// ---------- 段内存 / Segment memory ----------
+
+struct SegmentMemory {
+    void* data;
+    std::size_t bytes;
+    std::size_t align;
+    bool mapped;  ///< 来自 mmap / came from mmap
+};
+
+inline void touch_pages(void* data, std::size_t bytes) noexcept {
+    auto* p = static_cast<volatile unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; i += 4096) p[i] = 0;
+}
+
+// prefault 为 true 时即使未设置 populate 也预先缺页（reserve 使用）/ prefault forces faulting in even without populate (used by reserve)
+inline SegmentMemory allocate_segment(std::size_t bytes, std::size_t align, const SegmentOptions& options, bool prefault) {
+    bool fault_in = prefault || options.populate;
+#if defined(__linux__)
+    if (options.huge_pages || options.populate) {
+        std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        if (align <= page) {
+            std::size_t unit = options.huge_pages ? std::size_t(2) << 20 : page;
+            std::size_t len = (bytes + unit - 1) / unit * unit;
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+            // 大页须先 madvise 再缺页 / Huge pages must be advised before faulting in
+            if (fault_in && !options.huge_pages) flags |= MAP_POPULATE;
+            void* p = ::mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (p == MAP_FAILED) throw std::bad_alloc();
+            if (options.huge_pages) {
+                ::madvise(p, len, MADV_HUGEPAGE);
+                if (fault_in) touch_pages(p, len);
+            }
+            return { p, len, align, true };
+        }
+    }
+#endif
+    void* p = ::operator new(bytes, std::align_val_t(align));
+    if (fault_in) touch_pages(p, bytes);
+    return { p, bytes, align, false };
+}
+
+inline void free_segment(const SegmentMemory& mem) noexcept {
+#if defined(__linux__)
+    if (mem.mapped) {
+        ::munmap(mem.data, mem.bytes);
+        return;
+    }
+#endif
+    ::operator delete(mem.data, std::align_val_t(mem.align));
+}
+
+/**
+ * @brief 按节点尺寸划分的线程本地分段缓存 / Per-thread segmented cache keyed by node size
+ *
+ * - 每个线程一个 Cache，持有自己的分段和空闲链；本线程分配/释放为纯指针操作。
+ * - 每个槽位头部记录所属 Cache；其他线程释放时以 CAS 压入所属 Cache 的 remote 栈，
+ *   所属线程在本地空闲链耗尽时一次性取走整条 remote 栈（单消费者，无 ABA）。
+ * - 线程退出时 Cache 变为孤儿：仍有节点在外时，由最后一个归还者释放全部分段。
+ *
+ * - One Cache per thread owning its segments and free list; same-thread
+ *   allocate/release are plain pointer operations.
+ * - Each slot header records its owning Cache. A release on another thread
+ *   CAS-pushes the slot onto the owner's remote stack; the owner takes the
+ *   whole stack at once when its local list runs dry (single consumer, no ABA).
+ * - When the thread exits the Cache is orphaned; if nodes are still out, the
+ *   last one returned frees all segments.
+ */
+template <std::size_t Size, std::size_t Align>
+class ThreadCache {
+    struct Cache;
+    struct Slot;
+
+    union alignas(Align) Body {
+        Slot* next;
+        unsigned char storage[Size];
+    };
+
+    struct Slot {
+        Cache* owner;
+        Body body;
+    };
+
+    static constexpr std::size_t kInitialSegmentSlots = 64;
+    static constexpr std::size_t kMaxSegmentSlots = 8192;
+
+    static Slot* orphan_tag() noexcept { return reinterpret_cast<Slot*>(std::uintptr_t(1)); }
+
+    static Slot* slot_of(void* p) noexcept {
+        return reinterpret_cast<Slot*>(static_cast<unsigned char*>(p) - offsetof(Slot, body));
+    }
+
+    struct Segment {
+        Slot* slots;
+        std::size_t count;
+        SegmentMemory memory;
+    };
+
+    struct Cache {
+        Slot* local_free = nullptr;                 ///< 本线程空闲链 / same-thread free list
+        std::atomic<Slot*> remote_free{nullptr};    ///< 跨线程归还栈 / cross-thread return stack
+        std::atomic<std::size_t> orphan_live{0};    ///< 孤儿化后尚未归还的节点数 / nodes still out after orphaning
+        std::size_t live = 0;                       ///< 已分配未归还 / handed out, not yet returned
+        std::size_t free_count = 0;                 ///< local_free 的长度 / length of local_free
+        std::vector<Segment> segments;
+        Slot* bump = nullptr;
+        Slot* bump_end = nullptr;
+        std::size_t next_segment_slots = initial_segment_slots();
+
+        ~Cache() {
+            for (const Segment& seg : segments) release_segment(seg);
+        }
+
+        void* allocate() {
+            Slot* s = local_free;
+            if (!s) s = local_free = drain_remote();
+            if (s) {
+                local_free = s->body.next;
+                --free_count;
+            } else {
+                if (bump == bump_end) grow(1, false);
+                s = bump++;
+                s->owner = this;
+            }
+            ++live;
+            return &s->body;
+        }
+
+        void release_local(Slot* s) noexcept {
+            s->body.next = local_free;
+            local_free = s;
+            ++free_count;
+            --live;
+        }
+
+        void release_remote(Slot* s) noexcept {
+            Slot* head = remote_free.load(std::memory_order_acquire);
+            do {
+                if (head == orphan_tag()) {
+                    if (orphan_live.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+                    return;
+                }
+                s->body.next = head;
+            } while (!remote_free.compare_exchange_weak(head, s, std::memory_order_release,
+                                                        std::memory_order_acquire));
+        }
+
+        // 取走整条 remote 栈，计入 free_count；调用方负责把它挂到 local_free
+        // Take the whole remote stack, counted in free_count; the caller links it into local_free
+        Slot* drain_remote() noexcept {
+            Slot* list = remote_free.exchange(nullptr, std::memory_order_acquire);
+            for (Slot* s = list; s; s = s->body.next) {
+                --live;
+                ++free_count;
+            }
+            return list;
+        }
+
+        // 把 remote 栈整条接到 local_free 前面 / Prepend the whole remote stack to local_free
+        void absorb_remote() noexcept {
+            Slot* list = drain_remote();
+            if (!list) return;
+            Slot* tail = list;
+            while (tail->body.next) tail = tail->body.next;
+            tail->body.next = local_free;
+            local_free = list;
+        }
+
+        // 所属线程退出 / Owning thread exits
+        void orphan() noexcept {
+            orphan_live.store(live, std::memory_order_relaxed);
+            Slot* list = remote_free.exchange(orphan_tag(), std::memory_order_acq_rel);
+            std::size_t drained = 0;
+            for (Slot* s = list; s; s = s->body.next) ++drained;
+            if (orphan_live.fetch_sub(drained, std::memory_order_acq_rel) == drained) delete this;
+        }
+
+        // 新段至少 min_slots 个槽；当前段未切出的余量先挂入空闲链
+        // The new segment has at least min_slots slots; the unused tail of the current one goes onto the free list first
+        void grow(std::size_t min_slots, bool prefault) {
+            std::size_t n = std::max(next_segment_slots, min_slots);
+            SegmentMemory mem = allocate_segment(n * sizeof(Slot), alignof(Slot), options(), prefault);
+            try {
+                segments.push_back({ static_cast<Slot*>(mem.data), n, mem });
+            } catch (...) {
+                free_segment(mem);
+                throw;
+            }
+            while (bump != bump_end) {
+                Slot* s = bump++;
+                s->owner = this;
+                s->body.next = local_free;
+                local_free = s;
+                ++free_count;
+            }
+            bump = static_cast<Slot*>(mem.data);
+            bump_end = bump + n;
+            std::size_t growth = options().growth_factor ? options().growth_factor : 2;
+            next_segment_slots = std::min(next_segment_slots * growth, max_segment_slots());
+#ifdef POOLED_CONTAINER_STATS
+            // 段增长很少发生，共享原子计数的代价可忽略 / Segments grow rarely, so shared atomics cost nothing noticeable
+            segment_total.fetch_add(1, std::memory_order_relaxed);
+            slot_total.fetch_add(n, std::memory_order_relaxed);
+#endif
+        }
+
+        void reserve(std::size_t n) {
+            std::size_t available = free_count + static_cast<std::size_t>(bump_end - bump);
+            if (available < n) grow(n - available, true);
+        }
+
+        // 归还所有槽都空闲的段，返回释放的字节数 / Free every segment whose slots are all free; returns the bytes released
+        std::size_t trim() {
+            absorb_remote();
+            if (segments.empty()) return 0;
+
+            // 按地址排序后统计每段的空闲槽 / Count free slots per segment, segments sorted by address
+            std::vector<std::size_t> order(segments.size());
+            for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(),
+                      [this](std::size_t a, std::size_t b) { return segments[a].slots < segments[b].slots; });
+            auto segment_of = [&](Slot* s) {
+                auto it = std::upper_bound(order.begin(), order.end(), s,
+                                           [this](Slot* p, std::size_t i) { return p < segments[i].slots; });
+                return *(it - 1);
+            };
+            std::vector<std::size_t> free_in(segments.size(), 0);
+            for (Slot* s = local_free; s; s = s->body.next) ++free_in[segment_of(s)];
+
+            const std::size_t none = segments.size();
+            const std::size_t current = bump ? segments.size() - 1 : none; // bump 所在段 / the segment bump points into
+            std::vector<bool> drop(segments.size(), false);
+            bool any = false;
+            for (std::size_t i = 0; i < segments.size(); ++i) {
+                std::size_t carved = (i == current) ? static_cast<std::size_t>(bump - segments[i].slots) : segments[i].count;
+                drop[i] = free_in[i] == carved;
+                any = any || drop[i];
+            }
+            if (!any) return 0;
+
+            Slot** link = &local_free;
+            for (Slot* s = local_free; s; s = s->body.next) {
+                if (drop[segment_of(s)]) --free_count;
+                else { *link = s; link = &s->body.next; }
+            }
+            *link = nullptr;
+            if (current != none && drop[current]) bump = bump_end = nullptr;
+
+            std::size_t released = 0, kept = 0;
+            for (std::size_t i = 0; i < segments.size(); ++i) {
+                if (drop[i]) {
+                    released += segments[i].memory.bytes;
+                    release_segment(segments[i]);
+                } else {
+                    segments[kept++] = segments[i];
+                }
+            }
+            segments.resize(kept);
+            return released;
+        }
+
+        // 空闲链按地址升序排列，之后的分配依次落在更高的地址上 / Sort the free list by address so later allocations walk upwards
+        void order_free_list() {
+            absorb_remote();
+            std::vector<Slot*> slots;
+            slots.reserve(free_count);
+            for (Slot* s = local_free; s; s = s->body.next) slots.push_back(s);
+            std::sort(slots.begin(), slots.end());
+            Slot* head = nullptr;
+            for (auto it = slots.rbegin(); it != slots.rend(); ++it) {
+                (*it)->body.next = head;
+                head = *it;
+            }
+            local_free = head;
+        }
+
+        static void release_segment(const Segment& seg) noexcept {
+#ifdef POOLED_CONTAINER_STATS
+            segment_total.fetch_sub(1, std::memory_order_relaxed);
+            slot_total.fetch_sub(seg.count, std::memory_order_relaxed);
+#endif
+            free_segment(seg.memory);
+        }
+    };
+
+    // 段尺寸配置在各线程创建段时读取，应在分配开始前设置
+    // Segment options are read whenever a thread grows a segment, so set them before allocation starts
+    static inline SegmentOptions options_;
+
+    static const SegmentOptions& options() noexcept { return options_; }
+
+    static std::size_t initial_segment_slots() noexcept {
+        return options_.initial_bytes ? std::max<std::size_t>(1, options_.initial_bytes / sizeof(Slot)) : kInitialSegmentSlots;
+    }
+
+    static std::size_t max_segment_slots() noexcept {
+        return options_.max_bytes ? std::max<std::size_t>(1, options_.max_bytes / sizeof(Slot)) : kMaxSegmentSlots;
+    }
+
+    enum class State : unsigned char { Uninitialized, Active, Exited };
+
+#ifdef POOLED_CONTAINER_STATS
+    static inline std::atomic<std::size_t> segment_total{0};
+    static inline std::atomic<std::size_t> slot_total{0};
+#endif
+
+    static inline thread_local Cache* tl_cache = nullptr;
+    static inline thread_local State tl_state = State::Uninitialized;
+
+    struct Holder {
+        Holder() {
+            tl_cache = new Cache;
+            tl_state = State::Active;
+        }
+        ~Holder() {
+            Cache* c = tl_cache;
+            tl_cache = nullptr;
+            tl_state = State::Exited;
+            c->orphan();
+        }
+    };
+
+    static Cache* local() {
+        if (tl_cache) return tl_cache;
+        if (tl_state == State::Exited) return nullptr;
+        static thread_local Holder holder;
+        return tl_cache;
+    }
+
+public:
+    static void* allocate() {
+        if (Cache* c = local()) return c->allocate();
+        // 线程析构阶段的迟到分配：使用立即孤儿化的独立 Cache / Late allocation during thread teardown
+        Cache* detached = new Cache;
+        void* p = detached->allocate();
+        detached->orphan();
+        return p;
+    }
+
+    static void deallocate(void* p) noexcept {
+        Slot* s = slot_of(p);
+        Cache* owner = s->owner;
+        if (owner == tl_cache) owner->release_local(s);
+        else owner->release_remote(s);
+    }
+
+    /// 当前线程的缓存预留 n 个空闲槽，新段预先缺页 / Reserve n free slots in this thread's cache; the new segment is pre-faulted
+    static void reserve(std::size_t n) {
+        if (Cache* c = local()) c->reserve(n);
+    }
+
+    /// 归还当前线程缓存中完全空闲的段 / Free the fully free segments of this thread's cache
+    static std::size_t trim() {
+        if (tl_cache) return tl_cache->trim();
+        return 0;
+    }
+
+    static void configure(const SegmentOptions& options) noexcept { options_ = options; }
+
+    /// 当前线程空闲链按地址排序 / Sort the calling thread's free list by address
+    static void order_free_list() {
+        if (tl_cache) tl_cache->order_free_list();
+    }
+
+#ifdef POOLED_CONTAINER_STATS
+    // 所有线程的这一尺寸级别 / This size class across every thread
+    static PoolStats stats() {
+        PoolStats st = StatCounters<ThreadCache>::snapshot();
+        st.segments = segment_total.load(std::memory_order_relaxed);
+        std::size_t slots = slot_total.load(std::memory_order_relaxed);
+        st.segment_bytes = slots * sizeof(Slot);
+        st.free_nodes = slots > st.live ? slots - st.live : 0;
+        return st;
+    }
+#endif
+};
+
+} // namespace pooled_detail
+
+/**
+ * @brief 线程本地节点池策略 / Thread-local node pool policy
+ *
+ * 适合每个工作线程各自持有容器的场景：分配永远来自当前线程的缓存，
+ * 无锁且无跨核竞争；节点可以在任意线程释放。相同尺寸的节点类型共用缓存。
+ *
+ * Meant for one container per worker thread: allocation always comes from
+ * the calling thread's cache, with no lock and no cross-core contention;
+ * nodes may be released on any thread. Node types of the same size share
+ * caches.
+ */
+struct ThreadLocalPoolPolicy {
+    template <typename Node>
+    using node_base = PlainNodeBase;
+
+    // 多个线程可同时 create，各自落在本线程缓存 / Threads may create concurrently, each from its own cache
+    static constexpr bool concurrent_create = true;
+
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) const {
+        using Cache = pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>;
+        void* mem = Cache::allocate();
+        Node* node;
+        try {
+            node = new (mem) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            Cache::deallocate(mem);
+            throw;
+        }
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<Cache>::on_create();
+#endif
+        return node;
+    }
+
+    template <typename Node>
+    void recycle(Node* node) const {
+        using Cache = pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>;
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<Cache>::on_recycle();
+#endif
+        node->~Node();
+        Cache::deallocate(node);
+    }
+
+#ifdef POOLED_CONTAINER_STATS
+    // 尺寸与对齐相同的节点类型共用缓存，统计也按尺寸级别合计
+    // Node types of the same size and alignment share caches, so statistics cover the whole size class
+    template <typename Node>
+    PoolStats stats() const { return pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>::stats(); }
+
+    template <typename A, typename B>
+    static constexpr bool shared_stats = sizeof(A) == sizeof(B) && alignof(A) == alignof(B);
+#endif
+
+    /// 在当前线程的缓存中预留 n 个节点并预先缺页；应在将要分配的线程上调用
+    /// Reserve n nodes in the calling thread's cache, pre-faulted; call it on the thread that will allocate
+    template <typename Node>
+    void reserve(std::size_t n) const { pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>::reserve(n); }
+
+    /// 归还当前线程缓存中完全空闲的段，返回字节数 / Free the fully free segments of the calling thread's cache; returns the bytes
+    template <typename Node>
+    std::size_t trim() const { return pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>::trim(); }
+
+    /// 调用线程的空闲槽按地址排序，供 compact 使用 / Sort the calling thread's free slots by address, for compact
+    template <typename Node>
+    void order_free_list() const { pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>::order_free_list(); }
+
+    /// 设置该尺寸级别的段大小、增长倍数与预缺页/大页选项，应在分配开始前调用
+    /// Set segment size, growth factor and populate / huge page options for this size class; call before allocating
+    template <typename Node>
+    static void configure(const SegmentOptions& options) noexcept {
+        pooled_detail::ThreadCache<sizeof(Node), alignof(Node)>::configure(options);
+    }
+
+    // 节点自带所属缓存，任意实例都能正确归还 / Slots record their owning cache, so any instance returns them correctly
+    friend constexpr bool operator==(const ThreadLocalPoolPolicy&, const ThreadLocalPoolPolicy&) noexcept { return true; }
+    friend constexpr bool operator!=(const ThreadLocalPoolPolicy&, const ThreadLocalPoolPolicy&) noexcept { return false; }
+};
+
+/**
+ * @brief 会话级节点内存区 / Session-scoped node arena
+ *
+ * 按段顺序分配，同一容器的节点在内存中连续；单个节点归还后进入按（尺寸, 对齐）划分的空闲链，
+ * 供后续尺寸与对齐相同的节点复用。release() 一次性释放所有段，复杂度 O(段数)。
+ * 非线程安全；arena 必须比使用它的所有容器活得更久。
+ *
+ * Allocates sequentially from segments, so one container's nodes stay
+ * contiguous. Returned nodes go onto free lists keyed by (size, alignment)
+ * for reuse by later nodes of the same size and alignment. release() frees every segment at once in
+ * O(segments). Not thread-safe; the arena must outlive every container
+ * that uses it.
+ *
+ * 以 SegmentOptions 构造时可设置段的增长倍数、上限与预缺页/大页；默认每段大小相同。
+ * Constructed from SegmentOptions, segments can grow by a factor up to a cap
+ * and be pre-faulted or huge-page backed; by default every segment has the
+ * same size.
+ */
+class NodeArena {
+public:
+    explicit NodeArena(std::size_t segment_bytes = 64 * 1024) : segment_bytes_(segment_bytes) {}
+    explicit NodeArena(const SegmentOptions& options)
+        : options_(options), segment_bytes_(options.initial_bytes ? options.initial_bytes : 64 * 1024) {}
+    ~NodeArena() { release(); }
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /// align 须为 2 的幂，可大于段对齐 / align must be a power of two and may exceed the segment alignment
+    void* allocate(std::size_t size, std::size_t align) {
+        size = round_size(size);
+        for (FreeList& fl : free_lists_) {
+            if (fl.size == size && fl.align == align && fl.head) {
+                FreeSlot* s = fl.head;
+                fl.head = s->next;
+#ifdef POOLED_CONTAINER_STATS
+                --stats_.free_nodes;
+                count_allocation();
+#endif
+                return s;
+            }
+        }
+        // 按实际地址对齐，而非段内偏移 / Align the actual address, not the offset within the segment
+        std::size_t offset = capacity_ ? aligned_offset(align) : 0;
+        if (capacity_ == 0 || offset + size > capacity_) {
+            grow(size + align, false);
+            offset = aligned_offset(align);
+        }
+        segments_.back().padding += offset - used_;
+        used_ = offset + size;
+#ifdef POOLED_CONTAINER_STATS
+        count_allocation();
+#endif
+        return segments_.back().data + offset;
+    }
+
+    /// size 与 align 须与 allocate 时相同 / size and align must match the allocate() call
+    void deallocate(void* p, std::size_t size, std::size_t align) noexcept {
+#ifdef POOLED_CONTAINER_STATS
+        ++stats_.recycles;
+        --stats_.live;
+        ++stats_.free_nodes;
+#endif
+        size = round_size(size);
+        FreeSlot* s = static_cast<FreeSlot*>(p);
+        for (FreeList& fl : free_lists_) {
+            if (fl.size == size && fl.align == align) {
+                s->next = fl.head;
+                fl.head = s;
+                return;
+            }
+        }
+        s->next = nullptr;
+        try {
+            free_lists_.push_back({ size, align, s });
+        } catch (...) {
+            // 记账失败时仅放弃复用该槽，内存仍随 arena 释放 / On failure the slot is just not reused
+        }
+    }
+
+    /// 释放全部段；此前分配的节点全部失效 / Free every segment; all nodes become invalid
+    void release() noexcept {
+        for (Segment& seg : segments_) pooled_detail::free_segment(seg.memory);
+        segments_.clear();
+        free_lists_.clear();
+        used_ = capacity_ = 0;
+#ifdef POOLED_CONTAINER_STATS
+        stats_.live = stats_.free_nodes = stats_.segments = stats_.segment_bytes = 0;
+#endif
+    }
+
+    std::size_t segment_count() const noexcept { return segments_.size(); }
+
+    /// 保证当前段还能连续分配 bytes 字节，不够时新开一段并预先缺页 / Make sure bytes more fit in the current segment, opening a pre-faulted one if not
+    void reserve(std::size_t bytes) {
+        if (capacity_ == 0 || capacity_ - used_ < bytes) grow(bytes + kSegmentAlign, true);
+    }
+
+    /// 各空闲链按地址升序排列 / Sort every free list by address
+    void order_free_lists() {
+        std::vector<FreeSlot*> slots;
+        for (FreeList& fl : free_lists_) {
+            slots.clear();
+            for (FreeSlot* s = fl.head; s; s = s->next) slots.push_back(s);
+            std::sort(slots.begin(), slots.end());
+            fl.head = nullptr;
+            for (auto it = slots.rbegin(); it != slots.rend(); ++it) {
+                (*it)->next = fl.head;
+                fl.head = *it;
+            }
+        }
+    }
+
+    /**
+     * @brief 归还完全空闲的段 / Free the segments that hold no live node
+     *
+     * 段内所有分配过的槽都在空闲链上时释放该段，并从空闲链中去掉这些槽；返回释放的字节数。
+     * O(空闲槽 × log 段数)。
+     * A segment is freed when every slot ever carved from it is back on a free
+     * list, and those slots leave the free lists; returns the bytes released.
+     * O(free slots × log segments).
+     */
+    std::size_t trim() {
+        if (segments_.empty()) return 0;
+        if (capacity_) segments_.back().used = used_;
+
+        std::vector<std::size_t> order(segments_.size());
+        for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(),
+                  [this](std::size_t a, std::size_t b) { return segments_[a].data < segments_[b].data; });
+        auto segment_of = [&](const void* p) {
+            auto it = std::upper_bound(order.begin(), order.end(), static_cast<const unsigned char*>(p),
+                                       [this](const unsigned char* q, std::size_t i) { return q < segments_[i].data; });
+            return *(it - 1);
+        };
+
+        std::vector<std::size_t> free_bytes(segments_.size(), 0);
+        for (const FreeList& fl : free_lists_) {
+            for (FreeSlot* s = fl.head; s; s = s->next) free_bytes[segment_of(s)] += fl.size;
+        }
+        std::vector<bool> drop(segments_.size(), false);
+        bool any = false;
+        for (std::size_t i = 0; i < segments_.size(); ++i) {
+            drop[i] = free_bytes[i] == segments_[i].used - segments_[i].padding;
+            any = any || drop[i];
+        }
+        if (!any) return 0;
+
+        for (FreeList& fl : free_lists_) {
+            FreeSlot** link = &fl.head;
+            for (FreeSlot* s = fl.head; s; s = s->next) {
+                if (!drop[segment_of(s)]) { *link = s; link = &s->next; }
+#ifdef POOLED_CONTAINER_STATS
+                else --stats_.free_nodes;
+#endif
+            }
+            *link = nullptr;
+        }
+        if (capacity_ && drop.back()) used_ = capacity_ = 0;
+
+        std::size_t released = 0, kept = 0;
+        for (std::size_t i = 0; i < segments_.size(); ++i) {
+            if (drop[i]) {
+                released += segments_[i].memory.bytes;
+                pooled_detail::free_segment(segments_[i].memory);
+#ifdef POOLED_CONTAINER_STATS
+                --stats_.segments;
+                stats_.segment_bytes -= segments_[i].memory.bytes;
+#endif
+            } else {
+                segments_[kept++] = segments_[i];
+            }
+        }
+        segments_.resize(kept);
+        return released;
+    }
+
+#ifdef POOLED_CONTAINER_STATS
+    /// 整个 arena 的统计，不区分节点类型 / Statistics of the whole arena, across node types
+    PoolStats stats() const noexcept { return stats_; }
+#endif
+
+private:
+    struct FreeSlot { FreeSlot* next; };
+    struct FreeList { std::size_t size; std::size_t align; FreeSlot* head; };
+    struct Segment {
+        unsigned char* data;
+        pooled_detail::SegmentMemory memory;
+        std::size_t used = 0;     ///< 已切出的字节（当前段见 used_）/ bytes carved (see used_ for the current segment)
+        std::size_t padding = 0;  ///< 其中的对齐填充 / alignment padding among them
+    };
+
+    static constexpr std::size_t kSegmentAlign = 64;
+
+    static std::size_t round_size(std::size_t size) noexcept {
+        return std::max(size, sizeof(FreeSlot));
+    }
+
+    // 当前段中 used_ 之后首个满足 align 的偏移 / First offset at or after used_ in the current segment whose address satisfies align
+    std::size_t aligned_offset(std::size_t align) const noexcept {
+        std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(segments_.back().data) + used_;
+        return used_ + ((align - addr % align) % align);
+    }
+
+    void grow(std::size_t min_bytes, bool prefault) {
+        std::size_t bytes = std::max(segment_bytes_, min_bytes);
+        pooled_detail::SegmentMemory mem = pooled_detail::allocate_segment(bytes, kSegmentAlign, options_, prefault);
+        try {
+            segments_.push_back({ static_cast<unsigned char*>(mem.data), mem });
+        } catch (...) {
+            pooled_detail::free_segment(mem);
+            throw;
+        }
+        // 旧的当前段记下已切出的字节，余量不再使用 / The previous segment records its carved bytes; its tail goes unused
+        if (capacity_) segments_[segments_.size() - 2].used = used_;
+        used_ = 0;
+        capacity_ = bytes;
+        if (options_.growth_factor > 1) {
+            std::size_t cap = options_.max_bytes ? options_.max_bytes : std::size_t(-1) / 2;
+            segment_bytes_ = std::min(segment_bytes_ * options_.growth_factor, std::max(cap, segment_bytes_));
+        }
+#ifdef POOLED_CONTAINER_STATS
+        ++stats_.segments;
+        stats_.segment_bytes += bytes;
+#endif
+    }
+
+#ifdef POOLED_CONTAINER_STATS
+    void count_allocation() noexcept {
+        ++stats_.creates;
+        if (++stats_.live > stats_.peak_live) stats_.peak_live = stats_.live;
+    }
+
+    PoolStats stats_;
+#endif
+
+    SegmentOptions options_;
+    std::size_t segment_bytes_;
+    std::vector<Segment> segments_;
+    std::vector<FreeList> free_lists_;
+    std::size_t used_ = 0;
+    std::size_t capacity_ = 0;
+};
+
+/**
+ * @brief 按容器注入的 arena 策略 / Per-container arena policy
+ *
+ * 容器以 NodeArena 构造：`PooledMap<K, V, std::less<>, ArenaPoolPolicy> map(arena);`
+ * Containers are constructed from a NodeArena:
+ * `PooledMap<K, V, std::less<>, ArenaPoolPolicy> map(arena);`
+ */
+class ArenaPoolPolicy {
+public:
+    template <typename Node>
+    using node_base = PlainNodeBase;
+
+    static constexpr bool bulk_release = true;
+
+    ArenaPoolPolicy(NodeArena& arena) noexcept : arena_(&arena) {}
+
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) const {
+        void* mem = arena_->allocate(sizeof(Node), alignof(Node));
+        try {
+            return new (mem) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            arena_->deallocate(mem, sizeof(Node), alignof(Node));
+            throw;
+        }
+    }
+
+    template <typename Node>
+    void recycle(Node* node) const {
+        node->~Node();
+        arena_->deallocate(node, sizeof(Node), alignof(Node));
+    }
+
+    /// 仅析构，内存留给 arena 整体释放 / Destroy only; memory goes back with the arena
+    template <typename Node>
+    void discard(Node* node) const { node->~Node(); }
+
+    NodeArena& arena() const noexcept { return *arena_; }
+
+    /// 在 arena 当前段中预留 n 个节点的连续空间 / Reserve contiguous room for n nodes in the arena's current segment
+    template <typename Node>
+    void reserve(std::size_t n) const { arena_->reserve(n * std::max(sizeof(Node), sizeof(void*)) + alignof(Node)); }
+
+    /// 整个 arena 的完全空闲段，见 NodeArena::trim / The arena's fully free segments, see NodeArena::trim
+    template <typename Node>
+    std::size_t trim() const { return arena_->trim(); }
+
+    template <typename Node>
+    void order_free_list() const { arena_->order_free_lists(); }
+
+#ifdef POOLED_CONTAINER_STATS
+    template <typename Node>
+    PoolStats stats() const noexcept { return arena_->stats(); }
+
+    // 统计不区分节点类型 / Statistics do not tell node types apart
+    template <typename A, typename B>
+    static constexpr bool shared_stats = true;
+#endif
+
+    friend bool operator==(const ArenaPoolPolicy& a, const ArenaPoolPolicy& b) noexcept { return a.arena_ == b.arena_; }
+    friend bool operator!=(const ArenaPoolPolicy& a, const ArenaPoolPolicy& b) noexcept { return a.arena_ != b.arena_; }
+
+private:
+    NodeArena* arena_;
+};
+
+/**
+ * @brief 标准分配器适配策略 / Standard allocator adapter policy
+ *
+ * Alloc 会被 rebind 到节点类型。配合 std::pmr::monotonic_buffer_resource 即可得到
+ * 按会话整体释放的内存。
+ * Alloc is rebound to the node type. Combined with
+ * std::pmr::monotonic_buffer_resource it gives whole-session release.
+ */
+template <typename Alloc>
+class AllocatorPoolPolicy {
+public:
+    template <typename Node>
+    using node_base = PlainNodeBase;
+
+    AllocatorPoolPolicy() = default;
+    AllocatorPoolPolicy(const Alloc& alloc) : alloc_(alloc) {}
+
+    template <typename Node, typename... Args>
+    Node* create(Args&&... args) const {
+        auto alloc = rebind<Node>();
+        Node* mem = std::allocator_traits<decltype(alloc)>::allocate(alloc, 1);
+        Node* node;
+        try {
+            node = new (static_cast<void*>(mem)) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            std::allocator_traits<decltype(alloc)>::deallocate(alloc, mem, 1);
+            throw;
+        }
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<pooled_detail::StatTag<AllocatorPoolPolicy, Node>>::on_create();
+#endif
+        return node;
+    }
+
+    template <typename Node>
+    void recycle(Node* node) const {
+#ifdef POOLED_CONTAINER_STATS
+        pooled_detail::StatCounters<pooled_detail::StatTag<AllocatorPoolPolicy, Node>>::on_recycle();
+#endif
+        auto alloc = rebind<Node>();
+        node->~Node();
+        std::allocator_traits<decltype(alloc)>::deallocate(alloc, node, 1);
+    }
+
+    const Alloc& allocator() const noexcept { return alloc_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    // 分配器内部不可见，只报告计数 / The allocator's internals are opaque; counters only
+    template <typename Node>
+    PoolStats stats() const {
+        return pooled_detail::StatCounters<pooled_detail::StatTag<AllocatorPoolPolicy, Node>>::snapshot();
+    }
+#endif
+
+    friend bool operator==(const AllocatorPoolPolicy& a, const AllocatorPoolPolicy& b) noexcept { return a.alloc_ == b.alloc_; }
+    friend bool operator!=(const AllocatorPoolPolicy& a, const AllocatorPoolPolicy& b) noexcept { return !(a == b); }
+
+private:
+    template <typename Node>
+    typename std::allocator_traits<Alloc>::template rebind_alloc<Node> rebind() const {
+        return typename std::allocator_traits<Alloc>::template rebind_alloc<Node>(alloc_);
+    }
+
+    Alloc alloc_;
+};
+
+namespace pooled_detail {
+
+template <typename Pool, typename = void>
+struct supports_bulk_release : std::false_type {};
+
+template <typename Pool>
+struct supports_bulk_release<Pool, std::enable_if_t<Pool::bulk_release>> : std::true_type {};
+
+// 未声明 concurrent_create 的池只在一个线程上分配（并行批量操作随之串行构造结果）
+// Pools without concurrent_create allocate on one thread only (parallel bulk operations then build results serially)
+template <typename Pool, typename = void>
+struct supports_concurrent_create : std::false_type {};
+
+template <typename Pool>
+struct supports_concurrent_create<Pool, std::enable_if_t<Pool::concurrent_create>> : std::true_type {};
+
+// 可选的 reserve<Node>(n) / trim<Node>()；不提供时容器的 reserve / shrink_to_fit 什么也不做
+// Optional reserve<Node>(n) / trim<Node>(); without them a container's reserve / shrink_to_fit do nothing
+template <typename Pool, typename Node, typename = void>
+struct supports_reserve : std::false_type {};
+
+template <typename Pool, typename Node>
+struct supports_reserve<Pool, Node, std::void_t<decltype(std::declval<const Pool&>().template reserve<Node>(std::size_t()))>>
+    : std::true_type {};
+
+template <typename Pool, typename Node, typename = void>
+struct supports_trim : std::false_type {};
+
+template <typename Pool, typename Node>
+struct supports_trim<Pool, Node, std::void_t<decltype(std::declval<const Pool&>().template trim<Node>())>>
+    : std::true_type {};
+
+template <typename Pool, typename Node, typename = void>
+struct supports_order_free_list : std::false_type {};
+
+template <typename Pool, typename Node>
+struct supports_order_free_list<Pool, Node, std::void_t<decltype(std::declval<const Pool&>().template order_free_list<Node>())>>
+    : std::true_type {};
+
+template <typename Node, typename Pool>
+void order_free_nodes(const Pool& pool) {
+    if constexpr (supports_order_free_list<Pool, Node>::value) pool.template order_free_list<Node>();
+}
+
+template <typename Node, typename Pool>
+void reserve_nodes(const Pool& pool, std::size_t n) {
+    if constexpr (supports_reserve<Pool, Node>::value) pool.template reserve<Node>(n);
+}
+
+template <typename Node, typename Pool>
+std::size_t trim_nodes(const Pool& pool) {
+    if constexpr (supports_trim<Pool, Node>::value) return pool.template trim<Node>();
+    else return 0;
+}
+
+#ifdef POOLED_CONTAINER_STATS
+// 未声明 shared_stats 的池按节点类型分别计数 / Pools without shared_stats count each node type separately
+template <typename Pool, typename A, typename B, typename = void>
+struct stats_shared : std::false_type {};
+
+template <typename Pool, typename A, typename B>
+struct stats_shared<Pool, A, B, std::enable_if_t<Pool::template shared_stats<A, B>>> : std::true_type {};
+
+/// 两种节点类型的池统计，计数相同时只取一份 / Pool statistics of two node types, taken once when they share counters
+template <typename A, typename B, typename Pool>
+PoolStats combined_stats(const Pool& pool) {
+    PoolStats st = pool.template stats<A>();
+    if constexpr (!stats_shared<Pool, A, B>::value) st += pool.template stats<B>();
+    return st;
+}
+#endif
+
+} // namespace pooled_detail
@@ -0,0 +1,224 @@
+//
+//  PoolStats.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  节点池统计 / Node pool statistics
+//  -----------------------------------------------------------------------------
+//
+//  定义 POOLED_CONTAINER_STATS 后，各池策略在 create / recycle 时计数，
+//  容器提供 pool_stats()（PooledMap 另有 tree_stats()）。未定义时计数代码与相关成员
+//  全部不参与编译，容器布局与热路径与未加统计时完全相同。
+//
+//  计数按线程分片：每个线程只写自己的分片（relaxed 读改写，无 lock 前缀指令、无缓存行争用），
+//  读取统计时加锁汇总所有分片；线程退出时其分片并入全局累计值。
+//
+//  With POOLED_CONTAINER_STATS defined, every pool policy counts its
+//  create / recycle calls and the containers offer pool_stats() (plus
+//  tree_stats() on PooledMap). Without it the counting code and the related
+//  members are not compiled at all, so container layout and hot paths are
+//  exactly as they are without statistics.
+//
+//  Counters are sharded per thread: each thread writes only its own shard
+//  (relaxed load/store, no locked instructions, no cache-line contention),
+//  and reading the statistics sums every shard under a lock. A thread's
+//  shard is folded into a global total when the thread exits.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief 节点池统计快照 / Snapshot of node pool statistics
+ *
+ * - creates / recycles：累计的 create() 与 recycle() 次数。
+ * - live：当前已分配未归还的节点数；peak_live 为其历史最大值
+ *   （节点跨线程分配与归还时为各线程峰值之和，是真实峰值的上界）。
+ * - free_nodes、segments、segment_bytes：池已向系统申请的段及其中的空闲槽位，
+ *   由能观察到这些信息的池填写（线程本地缓存与 NodeArena）；
+ *   SegmentedObjectPool 不在本仓库内，默认策略下这三项为 0。
+ *
+ * - creates / recycles: cumulative create() and recycle() calls.
+ * - live: nodes handed out and not yet returned; peak_live is its high-water
+ *   mark (the sum of per-thread peaks, an upper bound of the true peak, when
+ *   nodes are created and recycled on different threads).
+ * - free_nodes, segments, segment_bytes: the segments a pool has obtained
+ *   and the unused slots in them, filled in by pools that can observe them
+ *   (the thread-local caches and NodeArena). SegmentedObjectPool lives
+ *   outside this repository, so these stay 0 with the default policy.
+ */
+struct PoolStats {
+    std::uint64_t creates = 0;
+    std::uint64_t recycles = 0;
+    std::size_t live = 0;
+    std::size_t peak_live = 0;
+    std::size_t free_nodes = 0;
+    std::size_t segments = 0;
+    std::size_t segment_bytes = 0;
+
+    PoolStats& operator+=(const PoolStats& other) noexcept {
+        creates += other.creates;
+        recycles += other.recycles;
+        live += other.live;
+        peak_live += other.peak_live;
+        free_nodes += other.free_nodes;
+        segments += other.segments;
+        segment_bytes += other.segment_bytes;
+        return *this;
+    }
+};
+
+#ifdef POOLED_CONTAINER_STATS
+
+namespace pooled_detail {
+
+// 统计对象的标签：某个池策略下的某种节点 / Counter tag: one node type under one pool policy
+template <typename Policy, typename Node>
+struct StatTag {};
+
+/**
+ * @brief 按线程分片的 create / recycle 计数器 / Per-thread sharded create / recycle counters
+ *
+ * Tag 区分计数对象（如某个策略下的某种节点）。分片只由所属线程写入，
+ * 因此以 relaxed load + store 自增，读取方可并发地 relaxed 读取。
+ *
+ * Tag tells counters apart (e.g. one node type under one policy). A shard is
+ * written only by its owning thread, so increments are a relaxed load plus
+ * store, and readers may load concurrently with relaxed ordering.
+ */
+template <typename Tag>
+class StatCounters {
+    struct Shard {
+        std::atomic<std::uint64_t> creates{0};
+        std::atomic<std::uint64_t> recycles{0};
+        std::atomic<std::int64_t> peak{0};
+        Shard* prev = nullptr;
+        Shard* next = nullptr;
+
+        void add(std::atomic<std::uint64_t>& c) noexcept { c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+        std::int64_t net() const noexcept {
+            return static_cast<std::int64_t>(creates.load(std::memory_order_relaxed) - recycles.load(std::memory_order_relaxed));
+        }
+    };
+
+    // 已退出线程的累计值 / Totals of threads that have exited
+    struct Registry {
+        std::mutex mutex;
+        Shard* head = nullptr;
+        std::uint64_t creates = 0;
+        std::uint64_t recycles = 0;
+        std::int64_t peak = 0;
+    };
+
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+
+    enum class State : unsigned char { Uninitialized, Active, Exited };
+
+    static inline thread_local Shard* tl_shard = nullptr;
+    static inline thread_local State tl_state = State::Uninitialized;
+
+    struct Holder {
+        Shard shard;
+        Holder() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            shard.next = r.head;
+            if (r.head) r.head->prev = &shard;
+            r.head = &shard;
+            tl_shard = &shard;
+            tl_state = State::Active;
+        }
+        ~Holder() {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (shard.prev) shard.prev->next = shard.next; else r.head = shard.next;
+            if (shard.next) shard.next->prev = shard.prev;
+            r.creates += shard.creates.load(std::memory_order_relaxed);
+            r.recycles += shard.recycles.load(std::memory_order_relaxed);
+            r.peak += shard.peak.load(std::memory_order_relaxed);
+            tl_shard = nullptr;
+            tl_state = State::Exited;
+        }
+    };
+
+    static Shard* local() {
+        if (tl_shard) return tl_shard;
+        if (tl_state == State::Exited) return nullptr;
+        static thread_local Holder holder;
+        return tl_shard;
+    }
+
+    // 线程析构阶段的迟到计数直接记入累计值 / Late counts during thread teardown go straight to the totals
+    static void add_retired(bool create) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (create) ++r.creates; else ++r.recycles;
+    }
+
+public:
+    static void on_create() {
+        if (Shard* s = local()) {
+            s->add(s->creates);
+            std::int64_t net = s->net();
+            if (net > s->peak.load(std::memory_order_relaxed)) s->peak.store(net, std::memory_order_relaxed);
+        } else {
+            add_retired(true);
+        }
+    }
+
+    static void on_recycle() {
+        if (Shard* s = local()) s->add(s->recycles);
+        else add_retired(false);
+    }
+
+    /// 汇总所有线程，只填写计数相关字段 / Sum every thread; fills in the counter fields only
+    static PoolStats snapshot() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        PoolStats st;
+        st.creates = r.creates;
+        st.recycles = r.recycles;
+        std::int64_t peak = r.peak;
+        for (Shard* s = r.head; s; s = s->next) {
+            st.creates += s->creates.load(std::memory_order_relaxed);
+            st.recycles += s->recycles.load(std::memory_order_relaxed);
+            peak += s->peak.load(std::memory_order_relaxed);
+        }
+        st.live = st.creates > st.recycles ? static_cast<std::size_t>(st.creates - st.recycles) : 0;
+        st.peak_live = peak > 0 ? static_cast<std::size_t>(peak) : 0;
+        if (st.peak_live < st.live) st.peak_live = st.live;
+        return st;
+    }
+};
+
+} // namespace pooled_detail
+
+#endif // POOLED_CONTAINER_STATS
@@ -0,0 +1,1007 @@
+//
+//  PooledBTreeMap.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  PooledBTreeMap 功能介绍 / Features
+//  -----------------------------------------------------------------------------
+//
+//  功能介绍：
+//  1. 基于 B+ 树的有序映射容器，接口与 PooledMap 一致，可直接替换。
+//  2. 每个节点占 NodeBytes 字节（默认 256，即 4 条缓存行），一次缓存未命中可比较几十个 key，
+//     树高约为红黑树的 1/4 ~ 1/5，查找时的指针追逐次数随之减少。
+//  3. 节点内查找无分支：算术 key 线性计数（整数键使用 SIMD），其他 key 使用无分支二分。
+//  4. 叶子与内部节点都通过 Pool 策略分配（默认共享 SegmentedObjectPool）。
+//  5. 叶子之间双向链接，顺序遍历与区间查询按内存顺序扫描。
+//
+//  Features:
+//  1. An ordered map built on a B+ tree, with the same interface as PooledMap
+//     so either can be chosen per workload without touching call sites.
+//  2. Every node spans NodeBytes bytes (256 by default, i.e. four cache lines),
+//     so a single miss covers dozens of keys and the tree is 4-5x shallower
+//     than a red-black tree: far fewer dependent pointer chases per lookup.
+//  3. Branch-free search inside a node: a linear count for arithmetic keys
+//     (SIMD for integer keys), a branch-free binary search otherwise.
+//  4. Leaves and inner nodes both come from the Pool policy (the shared
+//     SegmentedObjectPool by default).
+//  5. Leaves are doubly linked, so in-order and range scans walk memory
+//     sequentially.
+//
+//  与 PooledMap 的差异 / Differences from PooledMap:
+//  - 元素在节点内紧凑存放，插入或删除会移动同一节点内的其他元素，
+//    因此任何修改都可能使迭代器、引用与指针失效。
+//    Elements are packed inside nodes and insert/erase shift their
+//    neighbours, so ANY modification may invalidate iterators, references
+//    and pointers.
+//  - Key 与 Value 须可无异常移动构造；内部节点保存 key 的副本，因此 Key 须可拷贝。
+//    Key and Value must be nothrow move constructible; inner nodes hold
+//    copies of separator keys, so Key must be copyable.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "PoolPolicy.hpp"
+#include "RawSlots.hpp"
+#include "SimdKeySearch.hpp"
+
+namespace pooled_detail {
+
+// 无分支二分：返回 pred 为真的前缀长度（pred 须单调）
+// Branch-free binary search: length of the prefix on which pred holds (pred must be monotone)
+template <typename T, typename Pred>
+std::size_t branchless_partition_point(const T* base, std::size_t n, Pred&& pred) {
+    if (n == 0) return 0;
+    const T* first = base;
+    while (n > 1) {
+        std::size_t half = n / 2;
+        first = pred(first[half]) ? first + half : first;
+        n -= half;
+    }
+    return static_cast<std::size_t>(first - base) + (pred(*first) ? 1 : 0);
+}
+
+// 扣除头部后能放下的元素个数，至少为 3 / Slots that fit after the header, at least 3
+constexpr std::size_t btree_slots(std::size_t bytes, std::size_t header, std::size_t per_slot) noexcept {
+    return (bytes > header && (bytes - header) / per_slot > 3) ? (bytes - header) / per_slot : 3;
+}
+
+} // namespace pooled_detail
+
+/**
+ * @tparam NodeBytes 每个节点的目标字节数，建议为缓存行（64）的倍数或页大小 /
+ *                   Target bytes per node; a multiple of the cache line (64) or a page.
+ * @tparam Compare   键比较器，默认 std::less<>（透明，支持异构查找）/
+ *                   Key comparator; defaults to std::less<> (transparent, enables heterogeneous lookup).
+ * @tparam Pool      节点池策略，见 PoolPolicy.hpp / Node pool policy, see PoolPolicy.hpp.
+ */
+template <typename Key, typename Value, std::size_t NodeBytes = 256,
+          typename Compare = std::less<>, typename Pool = SegmentedPoolPolicy>
+class PooledBTreeMap {
+    struct Leaf;
+    struct Inner;
+
+    static_assert(std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<Value>,
+                  "PooledBTreeMap relocates elements inside nodes and needs nothrow move construction");
+
+public:
+    /// 每个叶子的元素数 / Elements per leaf
+    static constexpr std::size_t leaf_capacity =
+        pooled_detail::btree_slots(NodeBytes, 4 * sizeof(void*), sizeof(Key) + sizeof(Value));
+
+    /// 每个内部节点的分隔键数（另留一个插入时使用的备用槽）/ Separator keys per inner node (plus one spare slot used while inserting)
+    static constexpr std::size_t inner_capacity =
+        pooled_detail::btree_slots(NodeBytes, 4 * sizeof(void*) + sizeof(Key), sizeof(Key) + sizeof(void*));
+
+    static_assert(leaf_capacity <= 0xFFFF && inner_capacity < 0xFFFF, "NodeBytes is too large");
+
+    // ---------- 迭代器 / Iterators ----------
+
+    /**
+     * @brief 双向迭代器 / Bidirectional iterator
+     *
+     * 由 (叶子, 下标) 组成，沿叶子链表前进，++/-- 为 O(1)。
+     * 解引用得到 `std::pair<const Key&, Value&>` 代理。任何插入或删除都可能使其失效。
+     *
+     * A (leaf, slot) pair walking the leaf list: O(1) ++/--.
+     * Dereferencing yields a `std::pair<const Key&, Value&>` proxy. Any insert
+     * or erase may invalidate it.
+     */
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = std::pair<const Key, Value>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::pair<const Key&, std::conditional_t<Const, const Value&, Value&>>;
+
+        /// 箭头运算符代理 / Proxy returned by operator->
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        basic_iterator() = default;
+
+        /// 非 const 迭代器可隐式转换为 const 迭代器 / iterator converts to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept
+            : leaf_(other.leaf_), slot_(other.slot_), map_(other.map_) {}
+
+        reference operator*() const noexcept { return reference(leaf_->keys[slot_], leaf_->values[slot_]); }
+        pointer operator->() const noexcept { return pointer{**this}; }
+
+        const Key& key() const noexcept { return leaf_->keys[slot_]; }
+        std::conditional_t<Const, const Value&, Value&> value() const noexcept { return leaf_->values[slot_]; }
+
+        basic_iterator& operator++() noexcept {
+            if (++slot_ == leaf_->count) {
+                leaf_ = leaf_->next;
+                slot_ = 0;
+            }
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        /// end() 自减得到最大元素 / Decrementing end() yields the maximum element
+        basic_iterator& operator--() noexcept {
+            if (!leaf_) {
+                leaf_ = map_->last_;
+                slot_ = leaf_ ? leaf_->count - 1 : 0;
+            } else if (slot_ == 0) {
+                leaf_ = leaf_->prev;
+                slot_ = leaf_ ? leaf_->count - 1 : 0;
+            } else {
+                --slot_;
+            }
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const noexcept {
+            return leaf_ == other.leaf_ && slot_ == other.slot_;
+        }
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class PooledBTreeMap;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(Leaf* leaf, std::size_t slot, const PooledBTreeMap* map) noexcept
+            : leaf_(leaf), slot_(slot), map_(map) {}
+
+        Leaf* leaf_ = nullptr;
+        std::size_t slot_ = 0;
+        const PooledBTreeMap* map_ = nullptr;
+    };
+
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    PooledBTreeMap() = default;
+    explicit PooledBTreeMap(const Compare& comp) : comp_(comp) {}
+    explicit PooledBTreeMap(const Pool& pool) : pool_(pool) {}
+    PooledBTreeMap(const Compare& comp, const Pool& pool) : comp_(comp), pool_(pool) {}
+
+    PooledBTreeMap(const PooledBTreeMap&) = delete;
+    PooledBTreeMap& operator=(const PooledBTreeMap&) = delete;
+
+    ~PooledBTreeMap() { clear(); }
+
+    /// 移动构造，O(1)，other 变为空 / Move construction, O(1); other is left empty
+    PooledBTreeMap(PooledBTreeMap&& other) noexcept : comp_(other.comp_), pool_(other.pool_) { swap(other); }
+
+    /// 移动赋值：先归还自身节点再接管 / Move assignment: return own nodes, then take over
+    PooledBTreeMap& operator=(PooledBTreeMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /// 交换两个容器的全部内容，O(1)，不分配 / Swap the entire contents of two maps, O(1), no allocation
+    void swap(PooledBTreeMap& other) noexcept {
+        using std::swap;
+        swap(root_, other.root_);
+        swap(height_, other.height_);
+        swap(first_, other.first_);
+        swap(last_, other.last_);
+        swap(size_, other.size_);
+        swap(comp_, other.comp_);
+        swap(pool_, other.pool_);
+    }
+
+    friend void swap(PooledBTreeMap& a, PooledBTreeMap& b) noexcept { a.swap(b); }
+
+    iterator begin() noexcept { return iterator(first_, 0, this); }
+    const_iterator begin() const noexcept { return const_iterator(first_, 0, this); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator(nullptr, 0, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, 0, this); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    // ---------- 公共接口 / Public interface ----------
+
+    /**
+     * @brief 插入或访问键值对 / Insert or access key-value pair
+     *
+     * 行为与 PooledMap::operator[] 一致；返回的引用在下一次修改前有效。
+     * Same as PooledMap::operator[]; the reference stays valid until the next modification.
+     */
+    Value& operator[](const Key& key) { return try_emplace_impl(key).first.value(); }
+    Value& operator[](Key&& key) { return try_emplace_impl(std::move(key)).first.value(); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    Value& operator[](const K& key) { return try_emplace_impl(key).first.value(); }
+
+    /**
+     * @brief key 不存在时才原位构造 value / Construct the value in place only if key is absent
+     *
+     * 命中时不会移动或消耗参数。/ On a hit the arguments are left untouched.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 插入或赋值 / Insert, or assign to the existing value
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+    }
+
+    /**
+     * @brief 查找键 / Find by key
+     *
+     * 找到返回指向该元素的迭代器，否则返回 end()，不拷贝 Value。
+     * Returns an iterator to the element, or end() if not found. The value is never copied.
+     */
+    iterator find(const Key& key) { return find_impl<iterator>(key); }
+    const_iterator find(const Key& key) const { return find_impl<const_iterator>(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key) { return find_impl<iterator>(key); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& key) const { return find_impl<const_iterator>(key); }
+
+    /**
+     * @brief 查找并返回值指针 / Find and return a pointer to the value
+     *
+     * 未找到返回 nullptr；指针在下一次修改前有效。
+     * Returns nullptr on a miss; the pointer stays valid until the next modification.
+     */
+    Value* find_ptr(const Key& key) { return find_ptr_impl(key); }
+    const Value* find_ptr(const Key& key) const { return find_ptr_impl(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    Value* find_ptr(const K& key) { return find_ptr_impl(key); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const Value* find_ptr(const K& key) const { return find_ptr_impl(key); }
+
+    /**
+     * @brief 找到时以回调访问值 / Visit the value through a callback if found
+     */
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) { return visit_value(find_ptr_impl(key), func); }
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) const {
+        return visit_value(static_cast<const Value*>(find_ptr_impl(key)), func);
+    }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) { return visit_value(find_ptr_impl(key), func); }
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) const {
+        return visit_value(static_cast<const Value*>(find_ptr_impl(key)), func);
+    }
+
+    /**
+     * @brief 删除指定 key 的元素 / Erase element by key
+     *
+     * 删除成功返回 1，未找到返回 0。/ Returns 1 if erased, 0 if not found.
+     */
+    std::size_t erase(const Key& key) { return erase_impl(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t erase(const K& key) { return erase_impl(key); }
+
+    /// 判断 key 是否存在 / Check if key exists
+    bool contains(const Key& key) const { return find_ptr_impl(key) != nullptr; }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const { return find_ptr_impl(key) != nullptr; }
+
+    /// 返回当前大小 / Return current size
+    std::size_t size() const noexcept { return size_; }
+
+    /// 判断是否为空 / Check if empty
+    bool empty() const noexcept { return size_ == 0; }
+
+    /// 树高，仅有一个叶子时为 1 / Tree height; 1 for a single leaf
+    std::size_t height() const noexcept { return root_ ? height_ + 1 : 0; }
+
+    /// 返回比较器 / Return the key comparator
+    Compare key_comp() const { return comp_; }
+
+    /// 返回节点池策略 / Return the node pool policy
+    const Pool& get_pool() const noexcept { return pool_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    /**
+     * @brief 叶子与内部节点的池统计，见 PoolStats.hpp / Pool statistics of leaves and inner nodes, see PoolStats.hpp
+     *
+     * 按节点类型计数的池（默认、分配器）取两者之和；arena 报告整个 arena，线程本地池报告
+     * 尺寸级别，两种节点落在同一份计数里时只取一次。
+     * Pools that count per node type (default, allocator) report the sum of
+     * both; an arena reports the whole arena and the thread-local pool its
+     * size classes, taken once when both node types share the same counters.
+     */
+    PoolStats pool_stats() const { return pooled_detail::combined_stats<Leaf, Inner>(pool_); }
+#endif
+
+    /// 清空所有元素，逐个归还节点 / Remove every element, returning each node to the pool
+    void clear() noexcept {
+        if (root_) destroy_subtree(root_, height_, [this](auto* n) { pool_.recycle(n); });
+        reset_root();
+    }
+
+    /**
+     * @brief 整体丢弃所有节点 / Drop every node at once
+     *
+     * 同 PooledMap::release_all：池策略支持整体释放时只析构元素，否则等同于 clear()。
+     * Same as PooledMap::release_all: with a bulk-release pool only element
+     * destructors run; otherwise this is clear().
+     */
+    void release_all() noexcept {
+        if constexpr (pooled_detail::supports_bulk_release<Pool>::value) {
+            if constexpr (!(std::is_trivially_destructible_v<Key> && std::is_trivially_destructible_v<Value>)) {
+                if (root_) destroy_subtree(root_, height_, [this](auto* n) { pool_.discard(n); });
+            }
+            reset_root();
+        } else {
+            clear();
+        }
+    }
+
+    // ---------- 有序区间查询 / Ordered range queries ----------
+
+    /**
+     * @brief 第一个不小于 key 的位置 / First element whose key is not less than key
+     */
+    iterator lower_bound(const Key& key) { return bound_impl<iterator, false>(key); }
+    const_iterator lower_bound(const Key& key) const { return bound_impl<const_iterator, false>(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key) { return bound_impl<iterator, false>(key); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const { return bound_impl<const_iterator, false>(key); }
+
+    /**
+     * @brief 第一个大于 key 的位置 / First element whose key is greater than key
+     */
+    iterator upper_bound(const Key& key) { return bound_impl<iterator, true>(key); }
+    const_iterator upper_bound(const Key& key) const { return bound_impl<const_iterator, true>(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key) { return bound_impl<iterator, true>(key); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const { return bound_impl<const_iterator, true>(key); }
+
+    /**
+     * @brief 等于 key 的区间 [lower_bound, upper_bound) / Range of elements equal to key
+     */
+    std::pair<iterator, iterator> equal_range(const Key& key) {
+        return { lower_bound(key), upper_bound(key) };
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key) {
+        return { lower_bound(key), upper_bound(key) };
+    }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    /**
+     * @brief 顺序遍历 [lo, hi) 内的 key-value / Traverse key-value pairs in [lo, hi) in order
+     *
+     * 下降一次定位 lo，之后沿叶子链表顺序扫描。参数为 `(const Key&, Value&)`。
+     * Descends once to lo, then scans along the leaf list. Callback takes `(const Key&, Value&)`.
+     */
+    template <typename Func>
+    void for_each_range(const Key& lo, const Key& hi, Func&& func) {
+        for_each_range_impl(lo, hi, func);
+    }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    void for_each_range(const K& lo, const K& hi, Func&& func) {
+        for_each_range_impl(lo, hi, func);
+    }
+
+    // ---------- 遍历 / Traversal ----------
+    /**
+     * @brief 顺序遍历所有 key-value / Traverse all key-value in order
+     *
+     * 接收一个 lambda，参数为 `(const Key&, Value&)`；遍历中不可修改容器结构。
+     * Accepts a lambda with parameters `(const Key&, Value&)`; the map must
+     * not be structurally modified during the walk.
+     */
+    template <typename Func>
+    void for_each(Func&& func) {
+        for (Leaf* leaf = first_; leaf; leaf = leaf->next) {
+            for (std::size_t i = 0; i < leaf->count; ++i) func(leaf->keys[i], leaf->values[i]);
+        }
+    }
+
+    /// const 版本，参数为 `(const Key&, const Value&)` / Const overload with `(const Key&, const Value&)`
+    template <typename Func>
+    void for_each(Func&& func) const {
+        for (const Leaf* leaf = first_; leaf; leaf = leaf->next) {
+            for (std::size_t i = 0; i < leaf->count; ++i) func(leaf->keys[i], leaf->values[i]);
+        }
+    }
+
+private:
+    // ---------- 内部定义 / Internal definitions ----------
+
+    static constexpr std::size_t leaf_min  = leaf_capacity / 2;
+    static constexpr std::size_t inner_min = inner_capacity / 2;
+
+    // 每个内部节点至少两个孩子，64 层足以容纳任何规模 / Inner nodes have >= 2 children, so 64 levels always suffice
+    static constexpr std::size_t max_height = 64;
+
+    /// 叶子：有序的 key/value 数组与前后链接 / Leaf: sorted key/value arrays plus neighbour links
+    struct Leaf : public Pool::template node_base<Leaf> {
+        std::uint16_t count = 0;
+        Leaf* prev = nullptr;
+        Leaf* next = nullptr;
+        pooled_detail::RawSlots<Key, leaf_capacity> keys;
+        pooled_detail::RawSlots<Value, leaf_capacity> values;
+
+        Leaf() = default;
+        Leaf(const Leaf&) = delete;
+        Leaf& operator=(const Leaf&) = delete;
+        ~Leaf() {
+            for (std::size_t i = 0; i < count; ++i) {
+                keys[i].~Key();
+                values[i].~Value();
+            }
+        }
+    };
+
+    /**
+     * @brief 内部节点：count 个分隔键与 count + 1 个孩子 / Inner node: count separators, count + 1 children
+     *
+     * children[i] 中的 key 满足 keys[i-1] <= key < keys[i]。孩子在高度 1 时是 Leaf，否则是 Inner。
+     * Keys under children[i] satisfy keys[i-1] <= key < keys[i]. Children are
+     * leaves at height 1 and inner nodes above.
+     */
+    struct Inner : public Pool::template node_base<Inner> {
+        std::uint16_t count = 0;
+        pooled_detail::RawSlots<Key, inner_capacity + 1> keys;
+        void* children[inner_capacity + 2];
+
+        Inner() = default;
+        Inner(const Inner&) = delete;
+        Inner& operator=(const Inner&) = delete;
+        ~Inner() {
+            for (std::size_t i = 0; i < count; ++i) keys[i].~Key();
+        }
+    };
+
+    /// 下降路径上的一层：节点与所走的孩子下标 / One level of a descent: node and the child slot taken
+    struct PathEntry {
+        Inner* node;
+        std::size_t index;
+    };
+
+    void* root_ = nullptr;         ///< 根节点 / Root node
+    std::size_t height_ = 0;       ///< 根以下的内部层数 / Inner levels above the leaves
+    Leaf* first_ = nullptr;        ///< 最左叶子 / Leftmost leaf
+    Leaf* last_ = nullptr;         ///< 最右叶子 / Rightmost leaf
+    std::size_t size_ = 0;         ///< 元素数量 / Number of elements
+    Compare comp_;                 ///< 键比较器 / Key comparator
+    Pool pool_;                    ///< 节点池策略 / Node pool policy
+
+    void reset_root() noexcept {
+        root_ = nullptr;
+        first_ = last_ = nullptr;
+        height_ = 0;
+        size_ = 0;
+    }
+
+    // ---------- 节点内查找 / In-node search ----------
+    //
+    // 算术 key 配合 std::less 时逐个计数 `keys[i] < key`，没有分支；32/64 位整数键
+    // 使用 SimdKeySearch.hpp 中的 AVX2 / AVX-512 / NEON 内核。
+    // 其他情况使用无分支二分，比较次数为 log2(count) + 1。
+    //
+    // For arithmetic keys under std::less the search just counts
+    // `keys[i] < key` without branches; 32/64-bit integer keys use the AVX2 /
+    // AVX-512 / NEON kernels from SimdKeySearch.hpp. Everything else uses a
+    // branch-free binary search with log2(count) + 1 comparisons.
+
+    template <typename K>
+    static constexpr bool linear_search_v =
+        std::is_arithmetic_v<Key> && std::is_same_v<K, Key> &&
+        (std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<Key>>);
+
+    // 第一个 >= key 的下标 / Index of the first key >= key
+    template <typename K>
+    std::size_t lower_index(const Key* keys, std::size_t n, const K& key) const {
+        if constexpr (linear_search_v<K>) {
+            return pooled_simd::count_less(keys, n, key);
+        } else {
+            return pooled_detail::branchless_partition_point(keys, n, [&](const Key& k) { return comp_(k, key); });
+        }
+    }
+
+    // 第一个 > key 的下标 / Index of the first key > key
+    template <typename K>
+    std::size_t upper_index(const Key* keys, std::size_t n, const K& key) const {
+        if constexpr (linear_search_v<K>) {
+            return pooled_simd::count_less_equal(keys, n, key);
+        } else {
+            return pooled_detail::branchless_partition_point(keys, n, [&](const Key& k) { return !comp_(key, k); });
+        }
+    }
+
+    // 自根下降到 key 所在叶子，可选记录路径 / Descend to the leaf that owns key, optionally recording the path
+    template <typename K>
+    Leaf* descend(const K& key, PathEntry* path) const {
+        void* node = root_;
+        for (std::size_t h = height_; h > 0; --h) {
+            Inner* inner = static_cast<Inner*>(node);
+            std::size_t i = upper_index(inner->keys.data(), inner->count, key);
+            if (path) *path++ = { inner, i };
+            node = inner->children[i];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // ---------- 查找 / Lookup ----------
+
+    template <typename K>
+    std::pair<Leaf*, std::size_t> find_slot(const K& key) const {
+        if (!root_) return { nullptr, 0 };
+        Leaf* leaf = descend(key, nullptr);
+        std::size_t i = lower_index(leaf->keys.data(), leaf->count, key);
+        if (i < leaf->count && !comp_(key, leaf->keys[i])) return { leaf, i };
+        return { nullptr, 0 };
+    }
+
+    template <typename It, typename K>
+    It find_impl(const K& key) const {
+        auto slot = find_slot(key);
+        return It(slot.first, slot.second, this);
+    }
+
+    template <typename K>
+    Value* find_ptr_impl(const K& key) const {
+        auto slot = find_slot(key);
+        return slot.first ? &slot.first->values[slot.second] : nullptr;
+    }
+
+    template <typename It, bool Upper, typename K>
+    It bound_impl(const K& key) const {
+        if (!root_) return It(nullptr, 0, this);
+        Leaf* leaf = descend(key, nullptr);
+        std::size_t i = Upper ? upper_index(leaf->keys.data(), leaf->count, key)
+                              : lower_index(leaf->keys.data(), leaf->count, key);
+        // 叶子内全部小于 key 时答案是下一个叶子的首元素 / If the whole leaf precedes key, the answer opens the next leaf
+        if (i == leaf->count) return It(leaf->next, 0, this);
+        return It(leaf, i, this);
+    }
+
+    template <typename V, typename Func>
+    static bool visit_value(V* value, Func& func) {
+        if (!value) return false;
+        func(*value);
+        return true;
+    }
+
+    template <typename K, typename Func>
+    void for_each_range_impl(const K& lo, const K& hi, Func& func) {
+        iterator it = bound_impl<iterator, false>(lo);
+        for (Leaf* leaf = it.leaf_; leaf; leaf = leaf->next) {
+            for (std::size_t i = (leaf == it.leaf_) ? it.slot_ : 0; i < leaf->count; ++i) {
+                if (!comp_(leaf->keys[i], hi)) return;
+                func(leaf->keys[i], leaf->values[i]);
+            }
+        }
+    }
+
+    // ---------- 插入 / Insertion ----------
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args) {
+        if (!root_) {
+            Leaf* leaf = pool_.template create<Leaf>();
+            root_ = first_ = last_ = leaf;
+        }
+
+        PathEntry path[max_height];
+        Leaf* leaf = descend(key, path);
+        std::size_t i = lower_index(leaf->keys.data(), leaf->count, key);
+        if (i < leaf->count && !comp_(key, leaf->keys[i])) return { iterator(leaf, i, this), false };
+
+        if (leaf->count == leaf_capacity) std::tie(leaf, i) = split_leaf(leaf, i, path);
+        try {
+            emplace_at(leaf, i, std::forward<K>(key), std::forward<Args>(args)...);
+        } catch (...) {
+            // 首个元素构造失败时归还刚创建的空根 / Drop the empty root created for a failed first element
+            if (size_ == 0) clear();
+            throw;
+        }
+        ++size_;
+        return { iterator(leaf, i, this), true };
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& obj) {
+        auto slot = find_slot(key);
+        if (slot.first) {
+            slot.first->values[slot.second] = std::forward<M>(obj);
+            return { iterator(slot.first, slot.second, this), false };
+        }
+        return try_emplace_impl(std::forward<K>(key), std::forward<M>(obj));
+    }
+
+    // 在叶子的第 i 个槽原位构造元素，失败时恢复原状 / Construct an element at slot i, restoring the leaf on failure
+    template <typename K, typename... Args>
+    static void emplace_at(Leaf* leaf, std::size_t i, K&& key, Args&&... args) {
+        Key* keys = leaf->keys.data();
+        Value* values = leaf->values.data();
+        std::size_t tail = leaf->count - i;
+        pooled_detail::relocate(keys + i + 1, keys + i, tail);
+        pooled_detail::relocate(values + i + 1, values + i, tail);
+        try {
+            ::new (static_cast<void*>(keys + i)) Key(std::forward<K>(key));
+            try {
+                ::new (static_cast<void*>(values + i)) Value(std::forward<Args>(args)...);
+            } catch (...) {
+                keys[i].~Key();
+                throw;
+            }
+        } catch (...) {
+            pooled_detail::relocate(keys + i, keys + i + 1, tail);
+            pooled_detail::relocate(values + i, values + i + 1, tail);
+            throw;
+        }
+        ++leaf->count;
+    }
+
+    /**
+     * @brief 分裂满叶子，返回新元素应放入的 (叶子, 槽位) / Split a full leaf; returns the (leaf, slot) for the new element
+     *
+     * 先一次性申请沿途所有需要分裂的节点并拷贝分隔键，之后的结构调整只做无异常的重定位，
+     * 因此内存不足或 Key 拷贝失败时树保持不变。
+     *
+     * Every node the split will need along the path is allocated and the
+     * separator is copied up front; the restructuring that follows only does
+     * nothrow relocations, so running out of memory or a throwing Key copy
+     * leaves the tree untouched.
+     */
+    std::pair<Leaf*, std::size_t> split_leaf(Leaf* leaf, std::size_t pos, PathEntry* path) {
+        // 从叶子向上连续满的内部节点都会分裂，全满时还需要新根 / Consecutive full ancestors split too; a new root if all are full
+        std::size_t need = 0;
+        std::size_t d = height_;
+        while (d > 0 && path[d - 1].node->count == inner_capacity) {
+            ++need;
+            --d;
+        }
+        if (d == 0) ++need;
+
+        Inner* spare[max_height + 1];
+        std::size_t made = 0;
+        Leaf* right = nullptr;
+        // 旧元素的前 capacity/2 个留在左边；新元素不在右半首位，分隔键因此总是已有 key 的副本
+        // The first capacity/2 old elements stay left. The new element never opens
+        // the right half, so the separator is always a copy of an existing key.
+        std::size_t s = leaf_capacity / 2;
+        bool go_left = pos <= s;
+        pooled_detail::RawSlots<Key, 1> separator;
+        try {
+            for (; made < need; ++made) spare[made] = pool_.template create<Inner>();
+            right = pool_.template create<Leaf>();
+            ::new (static_cast<void*>(separator.data())) Key(leaf->keys[s]);
+        } catch (...) {
+            if (right) pool_.recycle(right);
+            while (made > 0) pool_.recycle(spare[--made]);
+            throw;
+        }
+
+        pooled_detail::relocate(right->keys.data(), leaf->keys.data() + s, leaf_capacity - s);
+        pooled_detail::relocate(right->values.data(), leaf->values.data() + s, leaf_capacity - s);
+        right->count = static_cast<std::uint16_t>(leaf_capacity - s);
+        leaf->count = static_cast<std::uint16_t>(s);
+
+        right->prev = leaf;
+        right->next = leaf->next;
+        if (leaf->next) leaf->next->prev = right;
+        else last_ = right;
+        leaf->next = right;
+
+        insert_separator_path(path, separator.data(), right, spare);
+        if (go_left) return { leaf, pos };
+        return { right, pos - s };
+    }
+
+    // 把分隔键与新右孩子逐层插入父节点，满则继续分裂 / Push a separator and new right child up the path, splitting full nodes
+    void insert_separator_path(PathEntry* path, Key* separator, void* right, Inner** spare) noexcept {
+        for (std::size_t d = height_; d-- > 0;) {
+            Inner* node = path[d].node;
+            insert_separator(node, path[d].index, separator, right);
+            if (node->count <= inner_capacity) return;
+
+            // count 为 capacity + 1：中间键上移，右半进入新节点 / count is capacity + 1: the middle key moves up, the right half moves out
+            Inner* sibling = *spare++;
+            std::size_t mid = node->count / 2;
+            std::size_t moved = node->count - mid - 1;
+            pooled_detail::relocate(sibling->keys.data(), node->keys.data() + mid + 1, moved);
+            std::memcpy(sibling->children, node->children + mid + 1, (moved + 1) * sizeof(void*));
+            sibling->count = static_cast<std::uint16_t>(moved);
+            pooled_detail::relocate(separator, node->keys.data() + mid, 1);
+            node->count = static_cast<std::uint16_t>(mid);
+            right = sibling;
+        }
+
+        Inner* top = *spare;
+        pooled_detail::relocate(top->keys.data(), separator, 1);
+        top->children[0] = root_;
+        top->children[1] = right;
+        top->count = 1;
+        root_ = top;
+        ++height_;
+    }
+
+    // 在孩子 i 之后插入 (分隔键, 右孩子)，可用到备用槽 / Insert (separator, right child) after child i; may use the spare slot
+    static void insert_separator(Inner* node, std::size_t i, Key* separator, void* right) noexcept {
+        Key* keys = node->keys.data();
+        pooled_detail::relocate(keys + i + 1, keys + i, node->count - i);
+        pooled_detail::relocate(keys + i, separator, 1);
+        std::memmove(node->children + i + 2, node->children + i + 1, (node->count - i) * sizeof(void*));
+        node->children[i + 1] = right;
+        ++node->count;
+    }
+
+    // ---------- 删除 / Erase ----------
+
+    template <typename K>
+    std::size_t erase_impl(const K& key) {
+        if (!root_) return 0;
+        PathEntry path[max_height];
+        Leaf* leaf = descend(key, path);
+        std::size_t i = lower_index(leaf->keys.data(), leaf->count, key);
+        if (i == leaf->count || comp_(key, leaf->keys[i])) return 0;
+
+        Key* keys = leaf->keys.data();
+        Value* values = leaf->values.data();
+        keys[i].~Key();
+        values[i].~Value();
+        pooled_detail::relocate(keys + i, keys + i + 1, leaf->count - i - 1);
+        pooled_detail::relocate(values + i, values + i + 1, leaf->count - i - 1);
+        --leaf->count;
+        --size_;
+        rebalance_leaf(leaf, path);
+        return 1;
+    }
+
+    /**
+     * @brief 叶子不足半满时向兄弟借一个元素或与兄弟合并 / Borrow from or merge with a sibling when a leaf falls below half
+     *
+     * 内部节点中的分隔键可以是已删除 key 的副本，只要仍能正确划分左右子树。
+     * Separators may be copies of keys that were already erased, as long as
+     * they still split the children correctly.
+     */
+    void rebalance_leaf(Leaf* leaf, PathEntry* path) {
+        if (height_ == 0) {
+            if (leaf->count == 0) clear();
+            return;
+        }
+        if (leaf->count >= leaf_min) return;
+
+        Inner* parent = path[height_ - 1].node;
+        std::size_t ci = path[height_ - 1].index;
+        Leaf* left = ci > 0 ? static_cast<Leaf*>(parent->children[ci - 1]) : nullptr;
+        Leaf* right = ci < parent->count ? static_cast<Leaf*>(parent->children[ci + 1]) : nullptr;
+
+        if (left && left->count > leaf_min) {
+            // 先更新分隔键，拷贝失败时不改动任何元素 / Update the separator first so a throwing copy changes nothing
+            std::size_t last = left->count - 1;
+            parent->keys[ci - 1] = left->keys[last];
+            pooled_detail::relocate(leaf->keys.data() + 1, leaf->keys.data(), leaf->count);
+            pooled_detail::relocate(leaf->values.data() + 1, leaf->values.data(), leaf->count);
+            pooled_detail::relocate(leaf->keys.data(), left->keys.data() + last, 1);
+            pooled_detail::relocate(leaf->values.data(), left->values.data() + last, 1);
+            --left->count;
+            ++leaf->count;
+            return;
+        }
+        if (right && right->count > leaf_min) {
+            parent->keys[ci] = right->keys[1];
+            pooled_detail::relocate(leaf->keys.data() + leaf->count, right->keys.data(), 1);
+            pooled_detail::relocate(leaf->values.data() + leaf->count, right->values.data(), 1);
+            pooled_detail::relocate(right->keys.data(), right->keys.data() + 1, right->count - 1);
+            pooled_detail::relocate(right->values.data(), right->values.data() + 1, right->count - 1);
+            --right->count;
+            ++leaf->count;
+            return;
+        }
+
+        if (left) {
+            merge_leaves(left, leaf);
+            remove_separator(parent, ci - 1);
+        } else {
+            merge_leaves(leaf, right);
+            remove_separator(parent, ci);
+        }
+        rebalance_inner(path, height_ - 1);
+    }
+
+    // right 并入 left 并归还 right / Fold right into left and recycle right
+    void merge_leaves(Leaf* left, Leaf* right) noexcept {
+        pooled_detail::relocate(left->keys.data() + left->count, right->keys.data(), right->count);
+        pooled_detail::relocate(left->values.data() + left->count, right->values.data(), right->count);
+        left->count = static_cast<std::uint16_t>(left->count + right->count);
+        right->count = 0;
+        left->next = right->next;
+        if (right->next) right->next->prev = left;
+        else last_ = left;
+        pool_.recycle(right);
+    }
+
+    // 删除分隔键 k 及其右侧孩子 / Remove separator k together with the child to its right
+    static void remove_separator(Inner* node, std::size_t k) noexcept {
+        node->keys[k].~Key();
+        close_separator_gap(node, k);
+    }
+
+    // 分隔键 k 已被移走，收拢键与孩子数组 / Separator k has been moved out: close the gap in keys and children
+    static void close_separator_gap(Inner* node, std::size_t k) noexcept {
+        pooled_detail::relocate(node->keys.data() + k, node->keys.data() + k + 1, node->count - k - 1);
+        std::memmove(node->children + k + 1, node->children + k + 2, (node->count - k - 1) * sizeof(void*));
+        --node->count;
+    }
+
+    // 自深度 d 向上修复不足半满的内部节点 / Repair under-full inner nodes from depth d upward
+    void rebalance_inner(PathEntry* path, std::size_t d) noexcept {
+        for (;;) {
+            Inner* node = path[d].node;
+            if (d == 0) {
+                // 根只剩一个孩子时降低树高 / Collapse a root that is down to one child
+                if (node->count == 0) {
+                    root_ = node->children[0];
+                    --height_;
+                    pool_.recycle(node);
+                }
+                return;
+            }
+            if (node->count >= inner_min) return;
+
+            Inner* parent = path[d - 1].node;
+            std::size_t ci = path[d - 1].index;
+            Inner* left = ci > 0 ? static_cast<Inner*>(parent->children[ci - 1]) : nullptr;
+            Inner* right = ci < parent->count ? static_cast<Inner*>(parent->children[ci + 1]) : nullptr;
+
+            if (left && left->count > inner_min) {
+                // 经父节点右旋一个键 / Rotate one key right through the parent
+                Key* keys = node->keys.data();
+                pooled_detail::relocate(keys + 1, keys, node->count);
+                pooled_detail::relocate(keys, parent->keys.data() + ci - 1, 1);
+                pooled_detail::relocate(parent->keys.data() + ci - 1, left->keys.data() + left->count - 1, 1);
+                std::memmove(node->children + 1, node->children, (node->count + 1) * sizeof(void*));
+                node->children[0] = left->children[left->count];
+                --left->count;
+                ++node->count;
+                return;
+            }
+            if (right && right->count > inner_min) {
+                // 经父节点左旋一个键 / Rotate one key left through the parent
+                pooled_detail::relocate(node->keys.data() + node->count, parent->keys.data() + ci, 1);
+                node->children[node->count + 1] = right->children[0];
+                ++node->count;
+                pooled_detail::relocate(parent->keys.data() + ci, right->keys.data(), 1);
+                pooled_detail::relocate(right->keys.data(), right->keys.data() + 1, right->count - 1);
+                std::memmove(right->children, right->children + 1, right->count * sizeof(void*));
+                --right->count;
+                return;
+            }
+
+            if (left) merge_inners(left, node, parent, ci - 1);
+            else merge_inners(node, right, parent, ci);
+            --d;
+        }
+    }
+
+    // left + 分隔键 k + right 合并进 left / Merge left, separator k and right into left
+    void merge_inners(Inner* left, Inner* right, Inner* parent, std::size_t k) noexcept {
+        pooled_detail::relocate(left->keys.data() + left->count, parent->keys.data() + k, 1);
+        pooled_detail::relocate(left->keys.data() + left->count + 1, right->keys.data(), right->count);
+        std::memcpy(left->children + left->count + 1, right->children, (right->count + 1) * sizeof(void*));
+        left->count = static_cast<std::uint16_t>(left->count + 1 + right->count);
+        right->count = 0;
+        close_separator_gap(parent, k);
+        pool_.recycle(right);
+    }
+
+    // ---------- 销毁 / Destruction ----------
+
+    // 树高为 O(log n)，递归深度有界 / Height is O(log n), so the recursion depth is bounded
+    template <typename Dispose>
+    static void destroy_subtree(void* node, std::size_t h, Dispose&& dispose) {
+        if (h == 0) {
+            dispose(static_cast<Leaf*>(node));
+            return;
+        }
+        Inner* inner = static_cast<Inner*>(node);
+        for (std::size_t i = 0; i <= inner->count; ++i) destroy_subtree(inner->children[i], h - 1, dispose);
+        dispose(inner);
+    }
+};
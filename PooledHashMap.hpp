@@ -0,0 +1,826 @@
+//
+//  PooledHashMap.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  PooledHashMap 功能介绍 / Features
+//  -----------------------------------------------------------------------------
+//
+//  功能介绍：
+//  1. 无序映射容器，接口与 PooledMap 一致（不含有序区间查询），平均 O(1) 访问。
+//  2. 开放寻址 + SwissTable 式控制字节：每个槽一个字节（空 / 已删除 / 哈希低 7 位），
+//     一次 SSE2 比较即可筛选 16 个槽；无 SSE2 时使用 8 字节 SWAR 分组。
+//  3. 元素存放在池化节点中（默认 SegmentedObjectPool），表中只保存节点指针，
+//     因此扩容不移动元素，引用与指针在元素被删除前始终有效。
+//  4. 渐进式扩容：超过负载上限时分配新表，之后每次插入只迁移固定数量的旧槽，
+//     单次插入不会因整表重哈希而出现延迟尖峰。节点缓存了哈希值，迁移时无需重新计算。
+//  5. 迭代按插入顺序进行（节点之间以侵入式双向链表相连）。
+//
+//  Features:
+//  1. An unordered map with the same interface as PooledMap (minus the ordered
+//     range queries) and average O(1) access.
+//  2. Open addressing with SwissTable-style control bytes: one byte per slot
+//     (empty / deleted / low 7 hash bits), so a single SSE2 compare filters 16
+//     slots; without SSE2 an 8-byte SWAR group is used.
+//  3. Elements live in pooled nodes (SegmentedObjectPool by default) and the
+//     table only holds node pointers, so growing never moves an element:
+//     references and pointers stay valid until the element is erased.
+//  4. Incremental rehashing: when the load limit is reached a new table is
+//     allocated and every later insert migrates a fixed number of old slots,
+//     so no single insert pays for a full rehash. Nodes cache their hash, so
+//     migration never rehashes a key.
+//  5. Iteration follows insertion order (nodes are linked through an
+//     intrusive doubly linked list).
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "PoolPolicy.hpp"
+
+#if !defined(POOLED_CONTAINER_NO_SIMD) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define POOLED_HASH_SSE2 1
+#  include <emmintrin.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#endif
+
+namespace pooled_detail {
+
+// 控制字节：非负值为占用槽的哈希低 7 位 / Control bytes: non-negative values are the low 7 hash bits of a full slot
+enum : std::int8_t { ctrl_empty = -128, ctrl_deleted = -2 };
+
+inline unsigned count_trailing_zeros(std::uint64_t x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<unsigned>(i);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+}
+
+// 分组内匹配结果，每个槽对应 2^shift 位 / Match result over one group; each slot owns 2^shift bits
+template <unsigned Shift>
+struct CtrlMask {
+    std::uint64_t bits;
+
+    explicit operator bool() const noexcept { return bits != 0; }
+    std::size_t lowest() const noexcept { return count_trailing_zeros(bits) >> Shift; }
+    void clear_lowest() noexcept { bits &= bits - 1; }
+};
+
+#if defined(POOLED_HASH_SSE2)
+
+/// 16 个控制字节，SSE2 比较 / 16 control bytes compared with SSE2
+struct CtrlGroup {
+    static constexpr std::size_t width = 16;
+    using mask = CtrlMask<0>;
+
+    explicit CtrlGroup(const std::int8_t* p) noexcept : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+    mask match(std::int8_t h2) const noexcept {
+        return mask{ static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))) };
+    }
+    mask match_empty() const noexcept { return match(ctrl_empty); }
+    // 空槽与已删除槽都是负数 / Empty and deleted are the negative values
+    mask match_free() const noexcept { return mask{ static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl)) }; }
+
+    __m128i ctrl;
+};
+
+#else
+
+/**
+ * @brief 8 个控制字节，SWAR 位运算比较 / 8 control bytes compared with SWAR bit tricks
+ *
+ * match 可能在真正命中的下一个字节上误报，误报的槽一定是占用槽，调用方会再比较哈希与 key。
+ * match may report a false positive on the byte after a real hit; such a slot
+ * is always full, and callers confirm with the hash and the key anyway.
+ */
+struct CtrlGroup {
+    static constexpr std::size_t width = 8;
+    using mask = CtrlMask<3>;
+
+    static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+    static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+    explicit CtrlGroup(const std::int8_t* p) noexcept {
+        std::memcpy(&ctrl, p, sizeof(ctrl));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        ctrl = __builtin_bswap64(ctrl);
+#endif
+    }
+
+    mask match(std::int8_t h2) const noexcept {
+        std::uint64_t x = ctrl ^ (lsbs * static_cast<std::uint8_t>(h2));
+        return mask{ (x - lsbs) & ~x & msbs };
+    }
+    // 0x80 为空、0xFE 为已删除：只有空槽的第 1 位为 0 / Empty 0x80 vs deleted 0xFE: only empty has bit 1 clear
+    mask match_empty() const noexcept { return mask{ ctrl & ~(ctrl << 6) & msbs }; }
+    mask match_free() const noexcept { return mask{ ctrl & msbs }; }
+
+    std::uint64_t ctrl;
+};
+
+#endif
+
+// 打散哈希值，使 std::hash 的恒等整数哈希也能均匀使用高低位 / Mix the hash so identity integer hashes spread over all bits
+inline std::size_t hash_mix(std::size_t h) noexcept {
+    if constexpr (sizeof(std::size_t) >= 8) {
+        std::uint64_t x = static_cast<std::uint64_t>(h) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(x ^ (x >> 32));
+    } else {
+        std::uint32_t x = static_cast<std::uint32_t>(h) * 0x9E3779B9u;
+        return static_cast<std::size_t>(x ^ (x >> 16));
+    }
+}
+
+} // namespace pooled_detail
+
+/**
+ * @tparam Hash     哈希函数，与 KeyEqual 同时透明时支持异构查找 /
+ *                  Hash function; heterogeneous lookup is enabled when both Hash and KeyEqual are transparent.
+ * @tparam KeyEqual 键相等比较，默认 std::equal_to<> / Key equality, defaults to std::equal_to<>.
+ * @tparam Pool     节点池策略，见 PoolPolicy.hpp / Node pool policy, see PoolPolicy.hpp.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<>, typename Pool = SegmentedPoolPolicy>
+class PooledHashMap {
+    struct Node;
+    using NodeType = Node;
+    using Group = pooled_detail::CtrlGroup;
+
+    // Hash 与 KeyEqual 均透明时才启用异构重载 / Heterogeneous overloads need both Hash and KeyEqual transparent
+    template <typename H, typename E>
+    using transparent_t = std::void_t<typename H::is_transparent, typename E::is_transparent>;
+
+public:
+    // ---------- 迭代器 / Iterators ----------
+
+    /**
+     * @brief 双向迭代器 / Bidirectional iterator
+     *
+     * 按插入顺序沿节点链表前进。插入与扩容不会使迭代器失效，删除只使指向被删元素的迭代器失效。
+     * Walks the node list in insertion order. Inserts and rehashing never
+     * invalidate iterators; erase only invalidates iterators to the erased element.
+     */
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = std::pair<const Key, Value>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::pair<const Key&, std::conditional_t<Const, const Value&, Value&>>;
+
+        /// 箭头运算符代理 / Proxy returned by operator->
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        basic_iterator() = default;
+
+        /// 非 const 迭代器可隐式转换为 const 迭代器 / iterator converts to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept
+            : node_(other.node_), map_(other.map_) {}
+
+        reference operator*() const noexcept { return reference(node_->key, node_->value); }
+        pointer operator->() const noexcept { return pointer{**this}; }
+
+        const Key& key() const noexcept { return node_->key; }
+        std::conditional_t<Const, const Value&, Value&> value() const noexcept { return node_->value; }
+
+        basic_iterator& operator++() noexcept {
+            node_ = node_->next;
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        /// end() 自减得到最后插入的元素 / Decrementing end() yields the most recently inserted element
+        basic_iterator& operator--() noexcept {
+            node_ = node_ ? node_->prev : map_->tail_;
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const noexcept { return node_ == other.node_; }
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const noexcept { return node_ != other.node_; }
+
+    private:
+        friend class PooledHashMap;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(NodeType* node, const PooledHashMap* map) noexcept : node_(node), map_(map) {}
+
+        NodeType* node_ = nullptr;
+        const PooledHashMap* map_ = nullptr;
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    PooledHashMap() = default;
+    explicit PooledHashMap(const Hash& hash, const KeyEqual& eq = KeyEqual()) : hash_(hash), eq_(eq) {}
+    explicit PooledHashMap(const Pool& pool) : pool_(pool) {}
+    PooledHashMap(const Hash& hash, const KeyEqual& eq, const Pool& pool) : hash_(hash), eq_(eq), pool_(pool) {}
+
+    PooledHashMap(const PooledHashMap&) = delete;
+    PooledHashMap& operator=(const PooledHashMap&) = delete;
+
+    ~PooledHashMap() {
+        clear();
+        free_table(table_);
+    }
+
+    /// 移动构造，O(1)，连同控制字节表一起接管；other 变为空 / Move construction, O(1), taking the control table too; other is left empty
+    PooledHashMap(PooledHashMap&& other) noexcept : hash_(other.hash_), eq_(other.eq_), pool_(other.pool_) { swap(other); }
+
+    /// 移动赋值：先归还自身节点再交换 / Move assignment: return own nodes, then swap
+    PooledHashMap& operator=(PooledHashMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /// 交换两个容器的全部内容，O(1)，不分配 / Swap the entire contents of two maps, O(1), no allocation
+    void swap(PooledHashMap& other) noexcept {
+        using std::swap;
+        swap(table_, other.table_);
+        swap(old_, other.old_);
+        swap(cursor_, other.cursor_);
+        swap(head_, other.head_);
+        swap(tail_, other.tail_);
+        swap(size_, other.size_);
+        swap(hash_, other.hash_);
+        swap(eq_, other.eq_);
+        swap(pool_, other.pool_);
+    }
+
+    friend void swap(PooledHashMap& a, PooledHashMap& b) noexcept { a.swap(b); }
+
+    iterator begin() noexcept { return iterator(head_, this); }
+    const_iterator begin() const noexcept { return const_iterator(head_, this); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator(nullptr, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, this); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // ---------- 公共接口 / Public interface ----------
+
+    /**
+     * @brief 插入或访问键值对 / Insert or access key-value pair
+     *
+     * 行为与 PooledMap::operator[] 一致；返回的引用在元素被删除前有效，扩容不影响。
+     * Same as PooledMap::operator[]; the reference stays valid until the element
+     * is erased, rehashing included.
+     */
+    Value& operator[](const Key& key) { return try_emplace_node(key).first->value; }
+    Value& operator[](Key&& key) { return try_emplace_node(std::move(key)).first->value; }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    Value& operator[](const K& key) { return try_emplace_node(key).first->value; }
+
+    /**
+     * @brief 原位构造插入 / Construct an element in place
+     *
+     * 与 PooledMap::emplace 一致，key 已存在时归还新节点并返回已有元素。
+     * Same as PooledMap::emplace; if the key exists the new node goes back to
+     * the pool and the existing element is returned.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        NodeType* node = pool_.template create<NodeType>(std::forward<Args>(args)...);
+        std::size_t hash = hash_of(node->key);
+        if (NodeType* found = find_node(node->key, hash)) {
+            pool_.recycle(node);
+            return { iterator(found, this), false };
+        }
+        try {
+            prepare_insert();
+        } catch (...) {
+            pool_.recycle(node);
+            throw;
+        }
+        link_node(node, hash);
+        return { iterator(node, this), true };
+    }
+
+    /**
+     * @brief key 不存在时才原位构造 value / Construct the value in place only if key is absent
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto r = try_emplace_node(key, std::forward<Args>(args)...);
+        return { iterator(r.first, this), r.second };
+    }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        auto r = try_emplace_node(std::move(key), std::forward<Args>(args)...);
+        return { iterator(r.first, this), r.second };
+    }
+
+    /**
+     * @brief 插入或赋值 / Insert, or assign to the existing value
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
+
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
+    }
+
+    /**
+     * @brief 查找键 / Find by key
+     *
+     * 找到返回指向该元素的迭代器，否则返回 end()，不拷贝 Value。
+     * Returns an iterator to the element, or end() if not found. The value is never copied.
+     */
+    iterator find(const Key& key) { return iterator(find_node(key, hash_of(key)), this); }
+    const_iterator find(const Key& key) const { return const_iterator(find_node(key, hash_of(key)), this); }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    iterator find(const K& key) { return iterator(find_node(key, hash_of(key)), this); }
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    const_iterator find(const K& key) const { return const_iterator(find_node(key, hash_of(key)), this); }
+
+    /**
+     * @brief 查找并返回值指针 / Find and return a pointer to the value
+     *
+     * 未找到返回 nullptr；指针在该元素被删除前保持有效。
+     * Returns nullptr on a miss; stays valid until that element is erased.
+     */
+    Value* find_ptr(const Key& key) { return value_ptr(find_node(key, hash_of(key))); }
+    const Value* find_ptr(const Key& key) const { return value_ptr(find_node(key, hash_of(key))); }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    Value* find_ptr(const K& key) { return value_ptr(find_node(key, hash_of(key))); }
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    const Value* find_ptr(const K& key) const { return value_ptr(find_node(key, hash_of(key))); }
+
+    /**
+     * @brief 找到时以回调访问值 / Visit the value through a callback if found
+     */
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) { return visit_node(find_node(key, hash_of(key)), func); }
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) const {
+        return visit_node(static_cast<const NodeType*>(find_node(key, hash_of(key))), func);
+    }
+
+    template <typename K, typename Func, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    bool try_get(const K& key, Func&& func) { return visit_node(find_node(key, hash_of(key)), func); }
+    template <typename K, typename Func, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    bool try_get(const K& key, Func&& func) const {
+        return visit_node(static_cast<const NodeType*>(find_node(key, hash_of(key))), func);
+    }
+
+    /**
+     * @brief 删除指定 key 的元素 / Erase element by key
+     *
+     * 删除成功返回 1，未找到返回 0。/ Returns 1 if erased, 0 if not found.
+     */
+    std::size_t erase(const Key& key) { return erase_impl(key); }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    std::size_t erase(const K& key) { return erase_impl(key); }
+
+    /// 判断 key 是否存在 / Check if key exists
+    bool contains(const Key& key) const { return find_node(key, hash_of(key)) != nullptr; }
+
+    template <typename K, typename H = Hash, typename E = KeyEqual, typename = transparent_t<H, E>>
+    bool contains(const K& key) const { return find_node(key, hash_of(key)) != nullptr; }
+
+    /// 返回当前大小 / Return current size
+    std::size_t size() const noexcept { return size_; }
+
+    /// 判断是否为空 / Check if empty
+    bool empty() const noexcept { return size_ == 0; }
+
+    /// 当前表的槽数 / Slot count of the current table
+    std::size_t bucket_count() const noexcept { return table_.capacity; }
+
+    /// 返回哈希函数 / Return the hash function
+    Hash hash_function() const { return hash_; }
+
+    /// 返回相等比较 / Return the key equality predicate
+    KeyEqual key_eq() const { return eq_; }
+
+    /// 返回节点池策略 / Return the node pool policy
+    const Pool& get_pool() const noexcept { return pool_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    /// 节点池统计，见 PoolStats.hpp / Node pool statistics, see PoolStats.hpp
+    PoolStats pool_stats() const { return pool_.template stats<NodeType>(); }
+#endif
+
+    /**
+     * @brief 预留至少容纳 n 个元素的空间 / Reserve room for at least n elements
+     *
+     * 一次性完成迁移并重建表，之后插入 n 个元素都不会再触发扩容；
+     * 池策略支持预留时同时备好其余节点（见 PooledMap::reserve）。
+     * Finishes any migration and rebuilds the table at once, so inserting up
+     * to n elements afterwards never grows it again. Pool policies that can
+     * reserve also set aside the missing nodes (see PooledMap::reserve).
+     */
+    void reserve(std::size_t n) {
+        if (n > size_) pooled_detail::reserve_nodes<NodeType>(pool_, n - size_);
+        std::size_t cap = capacity_for(n);
+        if (cap <= table_.capacity && !migrating()) return;
+        if (cap < table_.capacity) cap = table_.capacity;
+        finish_migration();
+        if (cap > table_.capacity) {
+            begin_rehash(cap);
+            finish_migration();
+        }
+    }
+
+    /// 清空所有元素，逐个归还节点，保留表空间 / Remove every element, returning each node; the table is kept
+    void clear() noexcept {
+        for (NodeType* cur = head_; cur;) {
+            NodeType* next = cur->next;
+            pool_.recycle(cur);
+            cur = next;
+        }
+        reset_nodes();
+    }
+
+    /**
+     * @brief 整体丢弃所有节点 / Drop every node at once
+     *
+     * 同 PooledMap::release_all：池策略支持整体释放时只析构元素，否则等同于 clear()。
+     * Same as PooledMap::release_all: with a bulk-release pool only element
+     * destructors run; otherwise this is clear().
+     */
+    void release_all() noexcept {
+        if constexpr (pooled_detail::supports_bulk_release<Pool>::value) {
+            if constexpr (!std::is_trivially_destructible_v<NodeType>) {
+                for (NodeType* cur = head_; cur;) {
+                    NodeType* next = cur->next;
+                    pool_.discard(cur);
+                    cur = next;
+                }
+            }
+            reset_nodes();
+        } else {
+            clear();
+        }
+    }
+
+    // ---------- 遍历 / Traversal ----------
+    /**
+     * @brief 按插入顺序遍历所有 key-value / Traverse all key-value pairs in insertion order
+     *
+     * 接收一个 lambda，参数为 `(const Key&, Value&)`。
+     * Accepts a lambda with parameters `(const Key&, Value&)`.
+     */
+    template <typename Func>
+    void for_each(Func&& func) {
+        for (NodeType* cur = head_; cur; cur = cur->next) func(cur->key, cur->value);
+    }
+
+    /// const 版本，参数为 `(const Key&, const Value&)` / Const overload with `(const Key&, const Value&)`
+    template <typename Func>
+    void for_each(Func&& func) const {
+        for (const NodeType* cur = head_; cur; cur = cur->next) func(cur->key, cur->value);
+    }
+
+private:
+    // ---------- 内部定义 / Internal definitions ----------
+
+    /**
+     * @brief 哈希节点 / Hash node
+     *
+     * 由 Pool 策略分配，缓存完整哈希值，并以双向链表串联用于遍历。
+     * Allocated through the Pool policy; caches the full hash and is linked
+     * into a doubly linked list for traversal.
+     */
+    struct Node : public Pool::template node_base<Node> {
+        Key key;
+        Value value;
+        std::size_t hash = 0;
+        Node* prev = nullptr;
+        Node* next = nullptr;
+
+        template <typename K, typename V>
+        Node(K&& k, V&& v) : key(std::forward<K>(k)), value(std::forward<V>(v)) {}
+
+        template <typename A, typename B>
+        Node(const std::pair<A, B>& kv) : key(kv.first), value(kv.second) {}
+
+        template <typename A, typename B>
+        Node(std::pair<A, B>&& kv) : key(std::forward<A>(kv.first)), value(std::forward<B>(kv.second)) {}
+
+        // 分段构造 / Piecewise construction
+        template <typename KArgs, typename VArgs>
+        Node(std::piecewise_construct_t, KArgs&& kargs, VArgs&& vargs)
+            : key(std::make_from_tuple<Key>(std::forward<KArgs>(kargs))),
+              value(std::make_from_tuple<Value>(std::forward<VArgs>(vargs))) {}
+    };
+
+    /// 一张开放寻址表：控制字节与节点指针同在一块内存 / One open-addressing table; control bytes and slots share one block
+    struct Table {
+        std::int8_t* ctrl = nullptr;
+        NodeType** slots = nullptr;
+        std::size_t capacity = 0;   ///< 槽数，2 的幂且不小于分组宽度 / Slots: a power of two, at least one group
+        std::size_t size = 0;       ///< 占用槽 / Full slots
+        std::size_t used = 0;       ///< 占用槽 + 已删除槽 / Full plus deleted slots
+    };
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // 每次插入迁移的旧槽数。新表容量不小于旧表，迁移完成前新插入不超过旧容量的 1/32，
+    // 新表因此不会在迁移期间再次触发扩容。
+    // Old slots migrated per insert. The new table is never smaller than the
+    // old one and at most old_capacity / 32 inserts land before migration
+    // completes, so the new table cannot fill up while migrating.
+    static constexpr std::size_t rehash_step = 32;
+
+    Table table_;                  ///< 当前表 / Current table
+    Table old_;                    ///< 迁移中的旧表 / Old table being migrated
+    std::size_t cursor_ = 0;       ///< 旧表迁移进度 / Migration cursor into the old table
+    NodeType* head_ = nullptr;     ///< 最早插入的节点 / Oldest node
+    NodeType* tail_ = nullptr;     ///< 最近插入的节点 / Newest node
+    std::size_t size_ = 0;         ///< 元素数量 / Number of elements
+    Hash hash_;                    ///< 哈希函数 / Hash function
+    KeyEqual eq_;                  ///< 相等比较 / Key equality
+    Pool pool_;                    ///< 节点池策略 / Node pool policy
+
+    template <typename K>
+    std::size_t hash_of(const K& key) const { return pooled_detail::hash_mix(hash_(key)); }
+
+    static std::int8_t h2(std::size_t hash) noexcept { return static_cast<std::int8_t>(hash & 0x7F); }
+    static std::size_t h1(std::size_t hash) noexcept { return hash >> 7; }
+
+    // 负载上限 7/8 / Load limit of 7/8
+    static std::size_t max_load(std::size_t capacity) noexcept { return capacity - capacity / 8; }
+
+    static std::size_t capacity_for(std::size_t n) noexcept {
+        std::size_t cap = Group::width;
+        while (max_load(cap) < n) cap *= 2;
+        return cap;
+    }
+
+    bool migrating() const noexcept { return old_.capacity != 0; }
+
+    // ---------- 表操作 / Table operations ----------
+    //
+    // 分组按 16（或 8）字节对齐，探测序列在分组间按三角数步长前进，
+    // 分组数是 2 的幂，因此会遍历所有分组。负载不超过 7/8，探测总能遇到空槽而终止。
+    //
+    // Groups are aligned to their width and probing steps between groups by
+    // triangular numbers; with a power-of-two group count that visits every
+    // group. Load never exceeds 7/8, so a probe always meets an empty slot.
+
+    static Table make_table(std::size_t capacity) {
+        Table t;
+        void* mem = ::operator new(capacity * (1 + sizeof(NodeType*)), std::align_val_t(Group::width));
+        t.ctrl = static_cast<std::int8_t*>(mem);
+        t.slots = reinterpret_cast<NodeType**>(t.ctrl + capacity);
+        std::memset(t.ctrl, static_cast<unsigned char>(pooled_detail::ctrl_empty), capacity);
+        t.capacity = capacity;
+        return t;
+    }
+
+    static void free_table(Table& t) noexcept {
+        if (t.ctrl) ::operator delete(t.ctrl, std::align_val_t(Group::width));
+        t = Table{};
+    }
+
+    template <typename K>
+    std::size_t table_find(const Table& t, const K& key, std::size_t hash) const {
+        if (t.size == 0) return npos;
+        std::size_t mask = t.capacity / Group::width - 1;
+        std::size_t g = h1(hash) & mask;
+        for (std::size_t step = 1;; ++step) {
+            Group group(t.ctrl + g * Group::width);
+            for (auto m = group.match(h2(hash)); m; m.clear_lowest()) {
+                std::size_t i = g * Group::width + m.lowest();
+                NodeType* node = t.slots[i];
+                if (node->hash == hash && eq_(node->key, key)) return i;
+            }
+            if (group.match_empty()) return npos;
+            g = (g + step) & mask;
+        }
+    }
+
+    // 探测序列上第一个空闲（空或已删除）槽 / First free (empty or deleted) slot on the probe sequence
+    static std::size_t find_free(const Table& t, std::size_t hash) noexcept {
+        std::size_t mask = t.capacity / Group::width - 1;
+        std::size_t g = h1(hash) & mask;
+        for (std::size_t step = 1;; ++step) {
+            auto m = Group(t.ctrl + g * Group::width).match_free();
+            if (m) return g * Group::width + m.lowest();
+            g = (g + step) & mask;
+        }
+    }
+
+    static void table_put(Table& t, NodeType* node) noexcept {
+        std::size_t i = find_free(t, node->hash);
+        t.used += (t.ctrl[i] == pooled_detail::ctrl_empty);
+        t.ctrl[i] = h2(node->hash);
+        t.slots[i] = node;
+        ++t.size;
+    }
+
+    // 所在分组仍有空槽时没有探测序列越过该组，可直接置空而非留下墓碑
+    // If the slot's group still has an empty slot no probe ever passed it, so it can become empty instead of a tombstone
+    static void table_erase(Table& t, std::size_t i) noexcept {
+        if (Group(t.ctrl + (i & ~(Group::width - 1))).match_empty()) {
+            t.ctrl[i] = pooled_detail::ctrl_empty;
+            --t.used;
+        } else {
+            t.ctrl[i] = pooled_detail::ctrl_deleted;
+        }
+        --t.size;
+    }
+
+    // ---------- 渐进式扩容 / Incremental rehash ----------
+
+    // 插入前：推进迁移，必要时开始新一轮扩容 / Before an insert: advance migration and start a new rehash if needed
+    void prepare_insert() {
+        if (migrating()) migrate_step();
+        if (table_.used + 1 <= max_load(table_.capacity)) return;
+
+        if (migrating()) finish_migration();
+        std::size_t cap = table_.capacity;
+        // 墓碑过多而元素不多时原容量重建，否则翻倍 / Rebuild at the same size when mostly tombstones, otherwise double
+        std::size_t target = cap == 0 ? Group::width : (table_.size + 1 > cap * 7 / 16 ? cap * 2 : cap);
+        begin_rehash(target);
+        migrate_step();
+    }
+
+    void begin_rehash(std::size_t capacity) {
+        Table fresh = make_table(capacity);
+        old_ = table_;
+        table_ = fresh;
+        cursor_ = 0;
+        if (old_.size == 0) free_table(old_);
+    }
+
+    // 每步迁移 rehash_step 个旧槽，已迁移的槽标记为已删除以保持旧表探测链 /
+    // Move rehash_step old slots per step; moved slots become tombstones so the old probe chains stay intact
+    void migrate_step() noexcept {
+        std::size_t end = cursor_ + rehash_step < old_.capacity ? cursor_ + rehash_step : old_.capacity;
+        for (; cursor_ < end; ++cursor_) {
+            if (old_.ctrl[cursor_] < 0) continue;
+            table_put(table_, old_.slots[cursor_]);
+            old_.ctrl[cursor_] = pooled_detail::ctrl_deleted;
+            --old_.size;
+        }
+        if (cursor_ == old_.capacity || old_.size == 0) free_table(old_);
+    }
+
+    void finish_migration() noexcept {
+        while (migrating()) migrate_step();
+    }
+
+    // ---------- 查找与插入 / Lookup and insertion ----------
+
+    // 迁移期间先查新表再查旧表，每个 key 只会在其中之一 / While migrating try the new table, then the old; a key lives in exactly one
+    template <typename K>
+    NodeType* find_node(const K& key, std::size_t hash) const {
+        std::size_t i = table_find(table_, key, hash);
+        if (i != npos) return table_.slots[i];
+        if (migrating()) {
+            i = table_find(old_, key, hash);
+            if (i != npos) return old_.slots[i];
+        }
+        return nullptr;
+    }
+
+    void link_node(NodeType* node, std::size_t hash) noexcept {
+        node->hash = hash;
+        node->prev = tail_;
+        node->next = nullptr;
+        if (tail_) tail_->next = node;
+        else head_ = node;
+        tail_ = node;
+        table_put(table_, node);
+        ++size_;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<NodeType*, bool> try_emplace_node(K&& key, Args&&... args) {
+        std::size_t hash = hash_of(key);
+        if (NodeType* found = find_node(key, hash)) return { found, false };
+
+        prepare_insert();
+        // key 与 value 均在池内存中原位构造 / Build key and value in place in pool memory
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+        link_node(node, hash);
+        return { node, true };
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& obj) {
+        std::size_t hash = hash_of(key);
+        if (NodeType* found = find_node(key, hash)) {
+            found->value = std::forward<M>(obj);
+            return { iterator(found, this), false };
+        }
+        prepare_insert();
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<M>(obj)));
+        link_node(node, hash);
+        return { iterator(node, this), true };
+    }
+
+    template <typename K>
+    std::size_t erase_impl(const K& key) {
+        std::size_t hash = hash_of(key);
+        NodeType* node = nullptr;
+        std::size_t i = table_find(table_, key, hash);
+        if (i != npos) {
+            node = table_.slots[i];
+            table_erase(table_, i);
+        } else if (migrating() && (i = table_find(old_, key, hash)) != npos) {
+            node = old_.slots[i];
+            table_erase(old_, i);
+            if (old_.size == 0) free_table(old_);
+        } else {
+            return 0;
+        }
+
+        if (node->prev) node->prev->next = node->next;
+        else head_ = node->next;
+        if (node->next) node->next->prev = node->prev;
+        else tail_ = node->prev;
+        pool_.recycle(node);
+        --size_;
+        return 1;
+    }
+
+    template <typename N>
+    static auto value_ptr(N* node) noexcept { return node ? &node->value : nullptr; }
+
+    template <typename N, typename Func>
+    static bool visit_node(N* node, Func& func) {
+        if (!node) return false;
+        func(node->value);
+        return true;
+    }
+
+    // 节点已全部回收或丢弃：清空链表与表，保留当前表空间 / All nodes are gone: reset the list and tables, keeping the current table
+    void reset_nodes() noexcept {
+        head_ = tail_ = nullptr;
+        size_ = 0;
+        free_table(old_);
+        cursor_ = 0;
+        if (table_.ctrl) {
+            std::memset(table_.ctrl, static_cast<unsigned char>(pooled_detail::ctrl_empty), table_.capacity);
+            table_.size = table_.used = 0;
+        }
+    }
+};
@@ -49,17 +49,279 @@
 //  Date:   2024-07-31
 //
 
+#pragma once
 #include <iostream>
 #include <vector>
 #include <type_traits>
 #include <string>
-#include "SegmentedObjectPool.hpp"
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+#include <tuple>
+#include <stdexcept>
+#include <algorithm>
+#include <optional>
+#include "PoolPolicy.hpp"
+#include "PooledSerialize.hpp"
+#include "PooledParallel.hpp"
 
-template <typename Key, typename Value>
+// 软件预取，用于批量查找 / Software prefetch used by the batched lookups
+#ifndef POOLED_PREFETCH
+#  if defined(__GNUC__) || defined(__clang__)
+#    define POOLED_PREFETCH(addr) __builtin_prefetch(addr)
+#  elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#    include <xmmintrin.h>
+#    define POOLED_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#  else
+#    define POOLED_PREFETCH(addr) ((void)(addr))
+#  endif
+#endif
+
+namespace pooled_detail {
+
+// 顺序统计增强：开启时每个节点记录子树大小，关闭时为空基类，节点布局不变
+// Order-statistic augmentation: with it on each node records its subtree size;
+// off, it is an empty base and the node layout is unchanged
+template <bool Enabled>
+struct SubtreeCount {};
+
+template <>
+struct SubtreeCount<true> {
+    std::size_t subtree_size = 1;
+};
+
+} // namespace pooled_detail
+
+/**
+ * @brief compact() 的节点内存布局 / Node memory layout used by compact()
+ *
+ * - InOrder：按键的升序依次分配，顺序遍历与区间扫描时内存地址单调递增。
+ * - VanEmdeBoas：按递归分块顺序分配，任意一条根到叶的路径只跨越 O(log_B n) 个缓存块，
+ *   适合以查找为主的负载；构建时需要 O(n) 的临时数组。
+ *
+ * - InOrder: nodes are allocated in ascending key order, so ordered walks
+ *   and range scans move monotonically through memory.
+ * - VanEmdeBoas: nodes are allocated in recursive block order, so any
+ *   root-to-leaf path touches O(log_B n) cache blocks; suits lookup-heavy
+ *   loads, and needs O(n) temporary arrays while building.
+ */
+enum class CompactLayout { InOrder, VanEmdeBoas };
+
+/**
+ * @tparam Compare 键比较器，默认 std::less<>（透明，支持异构查找）/
+ *                 Key comparator; defaults to std::less<> (transparent, enables heterogeneous lookup).
+ * @tparam Pool    节点池策略，见 PoolPolicy.hpp / Node pool policy, see PoolPolicy.hpp.
+ * @tparam OrderStatistic 为 true 时节点记录子树大小，提供 O(log n) 的 nth() / rank()；
+ *                 默认关闭，节点布局与性能不受影响 /
+ *                 When true, nodes record subtree sizes and nth() / rank() run in O(log n);
+ *                 off by default, leaving the node layout and speed untouched.
+ */
+template <typename Key, typename Value, typename Compare = std::less<>, typename Pool = SegmentedPoolPolicy,
+          bool OrderStatistic = false>
 class PooledMap {
+    struct Node;
+    using NodeType = Node;
+
 public:
+    // ---------- 迭代器 / Iterators ----------
+
+    /**
+     * @brief 双向迭代器 / Bidirectional iterator
+     *
+     * 基于节点的 parent 指针实现后继/前驱，++/-- 均摊 O(1)，无需递归或辅助栈。
+     * 解引用得到 `std::pair<const Key&, Value&>` 代理，支持 `it->first` / `it->second`
+     * 以及结构化绑定；插入不会使迭代器失效，删除只使指向被删节点的迭代器失效。
+     *
+     * Walks successors/predecessors through the nodes' parent pointers:
+     * amortized O(1) ++/--, no recursion or auxiliary stack.
+     * Dereferencing yields a `std::pair<const Key&, Value&>` proxy supporting
+     * `it->first` / `it->second` and structured bindings. Insertion never
+     * invalidates iterators; erase only invalidates iterators to the erased node.
+     */
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = std::pair<const Key, Value>;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::pair<const Key&, std::conditional_t<Const, const Value&, Value&>>;
+
+        /// 箭头运算符代理 / Proxy returned by operator->
+        struct pointer {
+            reference ref;
+            reference* operator->() noexcept { return &ref; }
+        };
+
+        basic_iterator() = default;
+
+        /// 非 const 迭代器可隐式转换为 const 迭代器 / iterator converts to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept
+            : node_(other.node_), map_(other.map_) {}
+
+        reference operator*() const noexcept { return reference(node_->key, node_->value); }
+        pointer operator->() const noexcept { return pointer{**this}; }
+
+        const Key& key() const noexcept { return node_->key; }
+        std::conditional_t<Const, const Value&, Value&> value() const noexcept { return node_->value; }
+
+        basic_iterator& operator++() noexcept {
+            node_ = successor(node_);
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        /// end() 自减得到最大节点 / Decrementing end() yields the maximum node
+        basic_iterator& operator--() noexcept {
+            node_ = node_ ? predecessor(node_) : (map_->root ? maximum(map_->root) : nullptr);
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const noexcept { return node_ == other.node_; }
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const noexcept { return node_ != other.node_; }
+
+    private:
+        friend class PooledMap;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(NodeType* node, const PooledMap* map) noexcept : node_(node), map_(map) {}
+
+        NodeType* node_ = nullptr;
+        const PooledMap* map_ = nullptr;
+    };
+
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
     PooledMap() = default;
-    ~PooledMap() { clear(root); }
+    explicit PooledMap(const Compare& comp) : comp_(comp) {}
+
+    /**
+     * @brief 使用指定的池实例构造 / Construct with a specific pool instance
+     *
+     * 例如每个会话一个 NodeArena / e.g. one NodeArena per session:
+     * `PooledMap<K, V, std::less<>, ArenaPoolPolicy> map(arena);`
+     */
+    explicit PooledMap(const Pool& pool) : pool_(pool) {}
+    PooledMap(const Compare& comp, const Pool& pool) : comp_(comp), pool_(pool) {}
+
+    ~PooledMap() {
+        clear(root);
+        recycle_chain(retired_);
+    }
+
+    // 节点归容器独占，隐式逐成员拷贝会导致重复 recycle，需要副本时显式调用 clone()
+    // Nodes are owned exclusively; a member-wise copy would recycle them
+    // twice, so copies are explicit through clone().
+    PooledMap(const PooledMap&) = delete;
+    PooledMap& operator=(const PooledMap&) = delete;
+
+    /**
+     * @brief 移动构造，O(1) / Move construction, O(1)
+     *
+     * 接管整棵树与池策略，不分配、不逐个搬移节点；other 变为空。
+     * Takes over the whole tree and the pool policy without allocating or
+     * touching individual nodes; other is left empty.
+     */
+    PooledMap(PooledMap&& other) noexcept : comp_(other.comp_), pool_(other.pool_) { swap(other); }
+
+    /// 移动赋值：先归还自身节点，再接管 other 的树 / Move assignment: return own nodes first, then take over other's tree
+    PooledMap& operator=(PooledMap&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    /// 交换两个容器的全部内容，O(1)，不分配 / Swap the entire contents of two maps, O(1), no allocation
+    void swap(PooledMap& other) noexcept {
+        using std::swap;
+        swap(root, other.root);
+        swap(size_, other.size_);
+        swap(comp_, other.comp_);
+        swap(pool_, other.pool_);
+        swap(retired_, other.retired_);
+#ifdef POOLED_CONTAINER_STATS
+        swap(rotations_, other.rotations_);
+#endif
+    }
+
+    friend void swap(PooledMap& a, PooledMap& b) noexcept { a.swap(b); }
+
+    /**
+     * @brief 显式深拷贝，O(n) / Explicit deep copy in O(n)
+     *
+     * 按中序逐个复制节点后自底向上建树（同 assign_sorted），不做比较与旋转；
+     * 可指定副本使用的池实例，默认与本容器相同。
+     *
+     * Copies the nodes in order and builds the tree bottom-up like
+     * assign_sorted, with no comparisons or rotations. The copy may use
+     * another pool instance; by default it shares this map's.
+     */
+    PooledMap clone() const { return clone(pool_); }
+
+    PooledMap clone(const Pool& pool) const {
+        PooledMap copy(comp_, pool);
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        try {
+            for (NodeType* cur = root ? minimum(root) : nullptr; cur; cur = successor(cur)) {
+                NodeType* node = copy.pool_.template create<NodeType>(std::piecewise_construct,
+                                                                      std::forward_as_tuple(cur->key),
+                                                                      std::forward_as_tuple(cur->value));
+                *tail = node;
+                tail = &node->right;
+            }
+        } catch (...) {
+            copy.recycle_chain(head);
+            throw;
+        }
+        copy.adopt_chain(head, size_);
+        return copy;
+    }
+
+    /**
+     * @brief 由有序序列 O(n) 构造 / Build from a sorted sequence in O(n)
+     *
+     * 见 assign_sorted。/ See assign_sorted.
+     */
+    template <typename ForwardIt>
+    static PooledMap from_sorted(ForwardIt first, ForwardIt last,
+                                 const Compare& comp = Compare(), const Pool& pool = Pool()) {
+        return PooledMap(sorted_tag{}, first, last, comp, pool);
+    }
+
+    iterator begin() noexcept { return iterator(root ? minimum(root) : nullptr, this); }
+    const_iterator begin() const noexcept { return const_iterator(root ? minimum(root) : nullptr, this); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator(nullptr, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, this); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
 
     // ---------- 公共接口 / Public interface ----------
 
@@ -69,52 +331,191 @@ public:
      * 行为与 std::map::operator[] 一致：
      * - 如果 key 已存在，返回对应 value 的引用；
      * - 如果 key 不存在，则插入默认构造的 value，并返回其引用。
+     * 比较器透明时可直接传入可比较的异构 key，只有在插入时才构造 Key。
      *
      * Behavior same as std::map::operator[]:
      * - If key exists, return reference to its value;
      * - If key does not exist, insert default-constructed value and return reference.
+     * With a transparent comparator any comparable key type is accepted;
+     * a Key is only constructed when an insertion actually happens.
      */
-    Value& operator[](const Key& key) {
-        NodeType* cur = root;
-        NodeType* parent = nullptr;
-        while (cur) {
-            Key& k = cur->key;
-            if (key == k) return cur->value;
-            parent = cur;
-            cur = (key < k) ? cur->left : cur->right;
+    Value& operator[](const Key& key) { return try_emplace_node(key).first->value; }
+    Value& operator[](Key&& key) { return try_emplace_node(std::move(key)).first->value; }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    Value& operator[](const K& key) { return try_emplace_node(key).first->value; }
+
+    /**
+     * @brief 原位构造插入 / Construct an element in place
+     *
+     * 与 std::map::emplace 一致：参数直接转发给池中节点的构造函数
+     * （`(key, value)`、`std::pair` 或 `std::piecewise_construct` 形式），
+     * 若 key 已存在则丢弃新节点并返回已有元素。
+     *
+     * Same as std::map::emplace: arguments are forwarded straight to the
+     * pooled node's constructor (`(key, value)`, a `std::pair`, or the
+     * `std::piecewise_construct` form). If the key already exists the new node
+     * is returned to the pool and the existing element is returned.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        NodeType* node = pool_.template create<NodeType>(std::forward<Args>(args)...);
+        InsertPos pos = find_insert_pos(node->key);
+        if (pos.match) {
+            pool_.recycle(node);
+            return { iterator(pos.match, this), false };
         }
+        link_node(node, pos);
+        return { iterator(node, this), true };
+    }
 
-        // 创建新节点 / Create a new node
-        NodeType* node = NodeType::create(key, Value());;
+    /**
+     * @brief key 不存在时才原位构造 value / Construct the value in place only if key is absent
+     *
+     * 先查找，未命中时才以 `args...` 在池内存中直接构造 value（分段构造 key 与 value，
+     * 不产生临时对象）；命中时不会移动或消耗参数。
+     *
+     * Looks up first; only on a miss is the value built from `args...` directly
+     * in pool memory (key and value constructed piecewise, no temporaries).
+     * On a hit the arguments are left untouched.
+     */
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        auto r = try_emplace_node(key, std::forward<Args>(args)...);
+        return { iterator(r.first, this), r.second };
+    }
 
-        node->left = node->right = node->parent = nullptr;
-        node->color = RED;
-        node->parent = parent;
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        auto r = try_emplace_node(std::move(key), std::forward<Args>(args)...);
+        return { iterator(r.first, this), r.second };
+    }
 
-        if (!root) root = node;
-        else if (key < parent->key) parent->left = node;
-        else parent->right = node;
+    /**
+     * @brief 插入或赋值 / Insert, or assign to the existing value
+     *
+     * key 已存在时把 obj 赋给已有 value，否则以 obj 原位构造新 value。
+     * second 为 true 表示发生了插入。
+     *
+     * Assigns obj to the existing value if key is present, otherwise constructs
+     * a new value from obj in place. second is true when an insertion happened.
+     */
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        return insert_or_assign_impl(key, std::forward<M>(obj));
+    }
 
-        // 红黑树插入修复 / Fix RB-tree property after insert
-        fix_insert(node);
-        ++size_;
-        return node->value;
+    template <typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(obj));
     }
 
     /**
-     * @brief 查找键对应的值 / Find value by key
+     * @brief 查找键 / Find by key
      *
-     * 如果找到返回对应值的拷贝，否则返回 Value() 默认值。
-     * If found, returns a copy of the value; otherwise returns default Value().
+     * 与 std::map::find 一致：找到返回指向该元素的迭代器，否则返回 end()，不拷贝 Value。
+     * Same as std::map::find: returns an iterator to the element, or end() if
+     * not found. The value is never copied.
      */
-    Value find(const Key& key) {
-        NodeType* cur = root;
-        while (cur) {
-            Key& k = cur->key;
-            if (key == k) return cur->value;
-            cur = (key < k) ? cur->left : cur->right;
-        }
-        return Value();
+    iterator find(const Key& key) { return iterator(find_node(key), this); }
+    const_iterator find(const Key& key) const { return const_iterator(find_node(key), this); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator find(const K& key) { return iterator(find_node(key), this); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator find(const K& key) const { return const_iterator(find_node(key), this); }
+
+    /**
+     * @brief 查找并返回值指针 / Find and return a pointer to the value
+     *
+     * 找到返回 value 的地址，否则返回 nullptr，可区分“未找到”与“存储的默认值”。
+     * 指针在该节点被删除前保持有效。
+     *
+     * Returns the address of the value, or nullptr on a miss, so a miss can be
+     * told apart from a stored default. Stays valid until that node is erased.
+     */
+    Value* find_ptr(const Key& key) {
+        NodeType* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+    const Value* find_ptr(const Key& key) const {
+        NodeType* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    Value* find_ptr(const K& key) {
+        NodeType* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const Value* find_ptr(const K& key) const {
+        NodeType* node = find_node(key);
+        return node ? &node->value : nullptr;
+    }
+
+    /**
+     * @brief 找到时以回调访问值 / Visit the value through a callback if found
+     *
+     * 找到时调用 `func(Value&)` 并返回 true，否则不调用并返回 false。
+     * Calls `func(Value&)` and returns true if found; otherwise returns false.
+     */
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) { return visit_node(find_node(key), func); }
+    template <typename Func>
+    bool try_get(const Key& key, Func&& func) const {
+        return visit_node(static_cast<const NodeType*>(find_node(key)), func);
+    }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) { return visit_node(find_node(key), func); }
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    bool try_get(const K& key, Func&& func) const {
+        return visit_node(static_cast<const NodeType*>(find_node(key)), func);
+    }
+
+    /**
+     * @brief 批量查找 / Look up many keys at once
+     *
+     * 对 keys[0..n) 逐个写出 value 指针（未找到为 nullptr），结果同 find_ptr。
+     * 每 16 个查找为一组同步推进：每一步让组内每个查找各下降一层，并预取其下一个节点，
+     * 各查找的缓存未命中因此相互重叠，而不是逐个串行等待内存。
+     *
+     * Writes one value pointer per key in keys[0..n) (nullptr on a miss), the
+     * same result as find_ptr. Lookups advance in lockstep groups of 16: each
+     * step moves every lookup in the group down one level and prefetches its
+     * next node, so the cache misses of independent lookups overlap instead of
+     * stalling one after another.
+     */
+    void find_batch(const Key* keys, std::size_t n, Value** out) {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node ? &node->value : nullptr; });
+    }
+    void find_batch(const Key* keys, std::size_t n, const Value** out) const {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node ? &node->value : nullptr; });
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    void find_batch(const K* keys, std::size_t n, Value** out) {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node ? &node->value : nullptr; });
+    }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    void find_batch(const K* keys, std::size_t n, const Value** out) const {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node ? &node->value : nullptr; });
+    }
+
+    /**
+     * @brief 批量判断 key 是否存在 / Check many keys at once
+     *
+     * 与 find_batch 相同的分组预取下降，out[i] 为 contains(keys[i])。
+     * Same grouped, prefetching descent as find_batch; out[i] is contains(keys[i]).
+     */
+    void contains_batch(const Key* keys, std::size_t n, bool* out) const {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node != nullptr; });
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    void contains_batch(const K* keys, std::size_t n, bool* out) const {
+        find_batch_impl(keys, n, [out](std::size_t i, NodeType* node) { out[i] = node != nullptr; });
     }
 
     /**
@@ -126,274 +527,1618 @@ public:
      * - Returns 1 if erase success;
      * - Returns 0 if key not found.
      */
-    std::size_t erase(const Key& key) {
-        NodeType* z = root;
-        while (z) {
-            Key& k = z->key;
-            if (key == k) break;
-            z = (key < k) ? z->left : z->right;
+    std::size_t erase(const Key& key) { return erase_node(find_node(key)); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t erase(const K& key) { return erase_node(find_node(key)); }
+
+    // ---------- 节点句柄 / Node handles ----------
+
+    /**
+     * @brief 节点句柄 / Node handle
+     *
+     * 与 std::map::node_type 相同：持有一个已从树中摘下、尚未归还池的节点，
+     * 可修改 key() 后 insert() 回本容器或任意池相等的 PooledMap；
+     * 句柄被丢弃时才把节点 recycle 回池。只可移动。
+     *
+     * Same as std::map::node_type: owns a node that has been unlinked from the
+     * tree but not returned to the pool. key() may be changed before the node
+     * is insert()ed into this map or any PooledMap with an equal pool; the node
+     * is only recycled if the handle is dropped. Move-only.
+     */
+    class node_type {
+    public:
+        node_type() = default;
+        node_type(node_type&& other) noexcept
+            : node_(std::exchange(other.node_, nullptr)), pool_(std::move(other.pool_)) {}
+        node_type& operator=(node_type&& other) noexcept {
+            if (this != &other) {
+                dispose();
+                node_ = std::exchange(other.node_, nullptr);
+                pool_ = std::move(other.pool_);
+            }
+            return *this;
         }
-        if (!z) return 0;
+        node_type(const node_type&) = delete;
+        node_type& operator=(const node_type&) = delete;
+        ~node_type() { dispose(); }
 
-        NodeType* y = z;
-        Color y_original_color = y->color;
-        NodeType* x = nullptr;
-        NodeType* x_parent = nullptr;
+        bool empty() const noexcept { return node_ == nullptr; }
+        explicit operator bool() const noexcept { return node_ != nullptr; }
+
+        Key& key() const noexcept { return node_->key; }
+        Value& mapped() const noexcept { return node_->value; }
+
+    private:
+        friend class PooledMap;
+
+        node_type(NodeType* node, const Pool& pool) : node_(node), pool_(pool) {}
+
+        void dispose() noexcept {
+            if (node_) pool_->recycle(node_);
+            node_ = nullptr;
+        }
+
+        NodeType* node_ = nullptr;
+        std::optional<Pool> pool_; // 池策略不一定可默认构造 / policies are not necessarily default-constructible
+    };
+
+    /// insert(node_type&&) 的结果 / Result of insert(node_type&&)
+    struct insert_return_type {
+        iterator position;
+        bool inserted;
+        node_type node;
+    };
+
+    /**
+     * @brief 摘下节点但不归还池 / Unlink a node without returning it to the pool
+     *
+     * 只做一次删除修复，不调用析构与 recycle；未找到时返回空句柄。
+     * Runs the erase rebalancing only, with no destructor or recycle call;
+     * returns an empty handle if the key is absent.
+     */
+    node_type extract(const_iterator pos) {
+        NodeType* node = pos.node_;
+        if (!node) return node_type();
+        unlink_node(node);
+        return node_type(node, pool_);
+    }
+
+    node_type extract(const Key& key) { return extract(const_iterator(find_node(key), this)); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    node_type extract(const K& key) { return extract(const_iterator(find_node(key), this)); }
+
+    /**
+     * @brief 插入节点句柄 / Insert a node handle
+     *
+     * 节点直接挂回树中，不分配；key 已存在时不插入，句柄原样交还到结果的 node 中。
+     * 句柄来自池不相等的容器时抛出 std::invalid_argument。
+     *
+     * Links the node straight back into the tree with no allocation. If the
+     * key already exists nothing is inserted and the handle comes back in the
+     * result's node. Throws std::invalid_argument if the handle comes from a
+     * map whose pool does not compare equal.
+     */
+    insert_return_type insert(node_type&& nh) {
+        if (nh.empty()) return { end(), false, node_type() };
+        if (!(pool_ == *nh.pool_)) throw std::invalid_argument("PooledMap node handle comes from a different pool");
+        InsertPos pos = find_insert_pos(nh.node_->key);
+        if (pos.match) return { iterator(pos.match, this), false, std::move(nh) };
+        NodeType* node = std::exchange(nh.node_, nullptr);
+        link_node(node, pos);
+        return { iterator(node, this), true, node_type() };
+    }
+
+    /**
+     * @brief 原地修改元素的 key / Change an element's key in place
+     *
+     * 新 key 仍落在前驱与后继之间时直接赋值，不做任何旋转；否则在树内摘下并重新挂接同一节点，
+     * 不经过池。新 key 已被其他元素占用时不做修改，返回指向该元素的迭代器与 false。
+     *
+     * If the new key still sorts between the element's neighbours it is
+     * assigned directly with no rotations; otherwise the same node is unlinked
+     * and relinked inside the tree without going through the pool. If another
+     * element already holds the new key nothing changes and the result is an
+     * iterator to that element with false.
+     */
+    template <typename K>
+    std::pair<iterator, bool> update_key(const_iterator pos, K&& new_key) {
+        NodeType* node = pos.node_;
+        NodeType* prev = predecessor(node);
+        NodeType* next = successor(node);
+        if ((!prev || comp_(prev->key, new_key)) && (!next || comp_(new_key, next->key))) {
+            node->key = std::forward<K>(new_key);
+            return { iterator(node, this), true };
+        }
+        InsertPos slot = find_insert_pos(new_key);
+        if (slot.match) return { iterator(slot.match, this), false };
+        unlink_node(node);
+        node->key = std::forward<K>(new_key);
+        link_node(node, find_insert_pos(node->key));
+        return { iterator(node, this), true };
+    }
+
+    /// 按旧 key 修改；旧 key 不存在时返回 {end(), false} / By old key; returns {end(), false} if it is absent
+    template <typename K>
+    std::pair<iterator, bool> update_key(const Key& old_key, K&& new_key) {
+        NodeType* node = find_node(old_key);
+        if (!node) return { end(), false };
+        return update_key(const_iterator(node, this), std::forward<K>(new_key));
+    }
+
+    /**
+     * @brief 合并另一个容器的节点 / Move the nodes of another map into this one
+     *
+     * 与 std::map::merge 相同：source 中 key 不重复的节点移入本容器，重复的留在 source。
+     * 节点只重新挂接，不分配也不 recycle。source 相对较大时两棵树各展平为有序链，
+     * 一次归并后自底向上重建（同 assign_sorted），O(n + m)、无旋转；
+     * source 很小时逐个挂接，O(m log n)。两个容器的池须相等，否则抛出 std::invalid_argument。
+     *
+     * Same as std::map::merge: nodes of source with keys not present here move
+     * into this map, duplicates stay in source. Nodes are relinked only, never
+     * allocated or recycled. When source is comparatively large both trees are
+     * flattened into sorted chains, merged in one pass and rebuilt bottom-up
+     * like assign_sorted: O(n + m) with no rotations. A small source is linked
+     * node by node in O(m log n). Both pools must compare equal, otherwise
+     * std::invalid_argument is thrown.
+     */
+    void merge(PooledMap& source) {
+        if (&source == this || source.empty()) return;
+        if (!(pool_ == source.pool_)) throw std::invalid_argument("PooledMap::merge requires interchangeable pools");
+
+        std::size_t log_n = 1;
+        while ((std::size_t(1) << log_n) <= size_) ++log_n;
+        if (source.size_ * log_n < size_) {
+            for (NodeType* cur = minimum(source.root); cur;) {
+                NodeType* next = successor(cur);
+                InsertPos pos = find_insert_pos(cur->key);
+                if (!pos.match) {
+                    source.unlink_node(cur);
+                    link_node(cur, pos);
+                }
+                cur = next;
+            }
+            return;
+        }
+
+        NodeType* a = flatten(root);
+        NodeType* b = flatten(source.root);
+        NodeType* merged = nullptr;
+        NodeType** tail = &merged;
+        NodeType* rest = nullptr;
+        NodeType** rest_tail = &rest;
+        std::size_t n = 0, k = 0;
+        while (a && b) {
+            NodeType** pick;
+            if (comp_(b->key, a->key)) pick = &b;
+            else {
+                if (!comp_(a->key, b->key)) {
+                    // 重复的 key 留在 source / Duplicate keys stay in source
+                    *rest_tail = b;
+                    rest_tail = &b->right;
+                    b = b->right;
+                    ++k;
+                }
+                pick = &a;
+            }
+            *tail = *pick;
+            tail = &(*pick)->right;
+            *pick = (*pick)->right;
+            ++n;
+        }
+        for (NodeType* r = a ? a : b; r; r = r->right) ++n;
+        *tail = a ? a : b;
+        *rest_tail = nullptr;
+
+        adopt_chain(merged, n);
+        source.adopt_chain(rest, k);
+    }
+
+    void merge(PooledMap&& source) { merge(source); }
+
+    /// 返回当前大小 / Return current size
+    std::size_t size() const noexcept { return size_; }
+
+    /// 判断是否为空 / Check if empty
+    bool empty() const noexcept { return size_ == 0; }
+
+    /// 返回比较器 / Return the key comparator
+    Compare key_comp() const { return comp_; }
+
+    /// 返回节点池策略 / Return the node pool policy
+    const Pool& get_pool() const noexcept { return pool_; }
+
+#ifdef POOLED_CONTAINER_STATS
+    /// 节点池统计，见 PoolStats.hpp / Node pool statistics, see PoolStats.hpp
+    PoolStats pool_stats() const { return pool_.template stats<NodeType>(); }
+
+    /// 树形统计 / Tree shape statistics
+    struct TreeStats {
+        std::size_t height = 0;        ///< 最长根到叶路径上的节点数 / nodes on the longest root-to-leaf path
+        std::size_t black_height = 0;  ///< 黑高 / black height
+        std::uint64_t rotations = 0;   ///< 插入与删除修复累计旋转次数 / rotations done by insert and erase fix-ups
+    };
+
+    /// 迭代遍历求高度，O(n)、额外空间 O(1) / Height by an iterative walk, O(n) with O(1) extra space
+    TreeStats tree_stats() const noexcept {
+        TreeStats st;
+        st.rotations = rotations_;
+        for (const NodeType* n = root; n; n = n->left) {
+            if (n->color() == BLACK) ++st.black_height;
+        }
+        std::size_t depth = 0;
+        const NodeType* prev = nullptr;
+        for (const NodeType* cur = root; cur;) {
+            const NodeType* next;
+            if (prev == cur->parent()) {
+                if (++depth > st.height) st.height = depth;
+                next = cur->left ? cur->left : cur->right ? cur->right : cur->parent();
+            } else if (prev == cur->left && cur->right) {
+                next = cur->right;
+            } else {
+                next = cur->parent();
+            }
+            if (next == cur->parent()) --depth;
+            prev = cur;
+            cur = next;
+        }
+        return st;
+    }
+#endif
+
+    /**
+     * @brief 预留 n 个节点 / Reserve n more nodes
+     *
+     * 让池策略一次备好 n 个节点的空间并预先缺页，之后 n 次插入不会触发段增长或缺页。
+     * 池策略不支持预留时（如默认的 SegmentedPoolPolicy）什么也不做；
+     * ThreadLocalPoolPolicy 预留在调用线程的缓存中。
+     *
+     * Lets the pool policy set aside pre-faulted room for n nodes at once, so
+     * the next n insertions neither grow a segment nor take a page fault.
+     * Does nothing when the policy cannot reserve (e.g. the default
+     * SegmentedPoolPolicy); ThreadLocalPoolPolicy reserves in the calling
+     * thread's cache.
+     */
+    void reserve(std::size_t n) { pooled_detail::reserve_nodes<NodeType>(pool_, n); }
+
+    /**
+     * @brief 把完全空闲的段归还系统 / Return fully free segments to the system
+     *
+     * 作用于整个池（可能被其他容器共用），不移动任何节点；返回释放的字节数，池不支持时为 0。
+     * Acts on the whole pool (which other containers may share) and never
+     * moves a node; returns the bytes released, 0 when the policy cannot trim.
+     */
+    std::size_t shrink_to_fit() { return pooled_detail::trim_nodes<NodeType>(pool_); }
+
+    /**
+     * @brief 整理节点内存，恢复局部性 / Relocate the nodes to restore memory locality
+     *
+     * 长时间插入删除后，相邻节点散落在各个段里。compact() 先让池把空闲槽按地址排序
+     * （池支持时，见 PoolPolicy.hpp 的 order_free_list），再按 layout 给出的顺序为每个元素
+     * 分配新节点并搬入键值（键值可无异常移动时移动，否则复制），随后归还旧节点、
+     * 重建为完全平衡的树，最后调用 shrink_to_fit() 归还完全空闲的段；返回其释放的字节数。
+     * 分配新节点时旧节点仍然存活，新节点不会落回旧槽，地址随分配顺序单调递增。
+     *
+     * O(n)，需要与元素数相当的空闲槽位；失败时原内容保持不变。
+     * 所有迭代器、引用与指针失效。
+     *
+     * After long insert/erase churn, neighbouring nodes are scattered across
+     * segments. compact() first asks the pool to sort its free slots by
+     * address (when it can, see order_free_list in PoolPolicy.hpp), then
+     * allocates a new node for every element in the order given by layout
+     * and moves the key and value in (moved when that cannot throw, copied
+     * otherwise). It then returns the old nodes, rebuilds a perfectly
+     * balanced tree, and finally calls shrink_to_fit() to release fully free
+     * segments, returning the bytes it released. The old nodes stay alive
+     * while the new ones are allocated, so no new node lands in an old slot
+     * and addresses rise with allocation order.
+     *
+     * O(n), needing free room for as many nodes again; on failure the map is
+     * unchanged. Invalidates every iterator, reference and pointer.
+     */
+    std::size_t compact(CompactLayout layout = CompactLayout::InOrder) {
+        flush_retired();
+        if (root) {
+            pooled_detail::order_free_nodes<NodeType>(pool_);
+            if (layout == CompactLayout::VanEmdeBoas) compact_veb();
+            else compact_in_order();
+        }
+        return shrink_to_fit();
+    }
+
+    /**
+     * @brief 增量整理：从 from 起按中序搬移至多 budget 个节点 / Incremental compaction: relocate up to budget nodes in order from from
+     *
+     * 每个节点换到新分配的节点中，就地接回原有的父子链接与颜色，不旋转、不比较；
+     * 返回下一次继续的位置，作为下一次调用的 from，整轮完成时返回 end()。
+     * 从 begin() 开始的一轮会先让池按地址排序空闲槽（耗时与空闲槽数成正比，只在开头一次）；
+     * 轮内被替换下来的旧节点暂不归还，以免后续节点落回旧槽，
+     * 整轮结束时统一归还并调用 shrink_to_fit()。每次调用 O(budget + log n)。
+     *
+     * 被搬移元素的迭代器、引用与指针失效，其余不受影响；两次调用之间可以正常增删，
+     * 但不能删除作为 from 的元素。未完成的一轮留下的旧节点在 compact()、clear() 或析构时归还。
+     *
+     * Each node is swapped for a freshly allocated one that takes over the
+     * old parent/child links and color in place, with no rotations or
+     * comparisons. Returns where to resume, to pass as from next time, or
+     * end() when the pass is complete. A pass starting at begin() first asks
+     * the pool to sort its free slots by address (time proportional to the
+     * free slots, once per pass). The old nodes replaced during a pass are
+     * held back so later nodes cannot land in them, and are returned together
+     * (followed by shrink_to_fit()) when the pass completes. Each call is
+     * O(budget + log n).
+     *
+     * Iterators, references and pointers to relocated elements are
+     * invalidated; all others stay valid. The map may be modified freely
+     * between calls, except for erasing the element passed as from. Old
+     * nodes left by an unfinished pass are returned by compact(), clear() or
+     * the destructor.
+     */
+    iterator compact_step(const_iterator from, std::size_t budget) {
+        NodeType* cur = from.node_;
+        if (cur && cur == minimum(root)) pooled_detail::order_free_nodes<NodeType>(pool_);
+        for (; cur && budget; --budget) {
+            NodeType* node = relocated_copy(cur);
+            replace_node(cur, node);
+            cur->right = retired_;
+            retired_ = cur;
+            cur = successor(node);
+        }
+        if (!cur) {
+            flush_retired();
+            shrink_to_fit();
+        }
+        return iterator(cur, this);
+    }
+
+    /// 清空所有元素，逐个归还节点 / Remove every element, returning each node to the pool
+    void clear() noexcept {
+        clear(root);
+        flush_retired();
+        root = nullptr;
+        size_ = 0;
+    }
+
+    /**
+     * @brief 整体丢弃所有节点 / Drop every node at once
+     *
+     * 池策略支持整体释放时（如 ArenaPoolPolicy），不逐个 recycle：
+     * 节点平凡析构时为 O(1)，否则只运行析构函数，节点内存随 arena.release() 一起归还。
+     * 其他池策略下等同于 clear()。
+     *
+     * With a bulk-release pool policy (e.g. ArenaPoolPolicy) nodes are not
+     * recycled one by one: O(1) when nodes are trivially destructible,
+     * otherwise only destructors run, and the memory goes back with
+     * arena.release(). With other policies this is the same as clear().
+     */
+    void release_all() noexcept {
+        flush_retired();
+        if constexpr (pooled_detail::supports_bulk_release<Pool>::value) {
+            if constexpr (!std::is_trivially_destructible_v<NodeType>) {
+                destroy_subtree(root, [this](NodeType* n) { pool_.discard(n); });
+            }
+            root = nullptr;
+            size_ = 0;
+        } else {
+            clear();
+        }
+    }
+
+    /**
+     * @brief 判断 key 是否存在 / Check if key exists
+     */
+    bool contains(const Key& key) const { return find_node(key) != nullptr; }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    bool contains(const K& key) const { return find_node(key) != nullptr; }
+
+    /**
+     * @brief 以严格升序序列替换全部内容，O(n) / Replace the contents with a strictly ascending sequence in O(n)
+     *
+     * 元素为 pair/tuple 形式的 (key, value)。自底向上直接构造完全平衡的红黑树：
+     * 不做逐个查找与 fix_insert 旋转，按最深不满层染红、其余染黑；
+     * 节点按中序顺序依次从池中分配，树序与内存顺序一致。
+     * key 不严格升序时抛出 std::invalid_argument，原内容保持不变。
+     *
+     * Elements are pair/tuple-like (key, value). Builds a perfectly balanced
+     * red-black tree bottom-up: no per-element descent and no fix_insert
+     * rotations; the incomplete bottom level is red, everything else black.
+     * Nodes are taken from the pool in in-order sequence, so tree order
+     * matches memory order. Throws std::invalid_argument (leaving the map
+     * unchanged) if keys are not strictly ascending.
+     */
+    template <typename ForwardIt>
+    void assign_sorted(ForwardIt first, ForwardIt last) {
+        if (first != last) {
+            for (ForwardIt prev = first, it = std::next(first); it != last; ++prev, ++it) {
+                if (!comp_(std::get<0>(*prev), std::get<0>(*it)))
+                    throw std::invalid_argument("PooledMap::assign_sorted requires strictly ascending keys");
+            }
+        }
+
+        // 先按中序创建节点并以 right 指针串成链 / Create nodes in order, chained through right
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        std::size_t n = 0;
+        try {
+            for (; first != last; ++first, ++n) {
+                auto&& e = *first;
+                NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                                                 std::forward_as_tuple(std::get<0>(e)),
+                                                                 std::forward_as_tuple(std::get<1>(e)));
+                *tail = node;
+                tail = &node->right;
+            }
+        } catch (...) {
+            recycle_chain(head);
+            throw;
+        }
+
+        clear();
+        adopt_chain(head, n);
+    }
+
+    /**
+     * @brief 按中序把全部元素写入 writer，O(n) / Stream every element to writer in order, O(n)
+     *
+     * 格式见 PooledSerialize.hpp：元素按约 64 KiB 的块攒好后整块调用一次 writer.write()，
+     * 可平凡复制的键值直接 memcpy 进块缓冲区；其他类型经 PooledCodec 编码。
+     * Format in PooledSerialize.hpp: elements are gathered into chunks of
+     * about 64 KiB and each chunk is one writer.write() call; trivially
+     * copyable keys and values are memcpy'd straight into the chunk buffer,
+     * other types go through PooledCodec.
+     */
+    template <typename Writer>
+    void serialize(Writer& writer) const {
+        pooled_detail::ChunkWriter<Writer> out(writer);
+        out.header(pooled_detail::StreamKind::Map, PooledCodec<Key>::fixed_size, PooledCodec<Value>::fixed_size, size_);
+        for (NodeType* cur = root ? minimum(root) : nullptr; cur; cur = successor(cur)) {
+            PooledCodec<Key>::write(out, cur->key);
+            PooledCodec<Value>::write(out, cur->value);
+            out.end_element();
+        }
+        out.finish();
+    }
+
+    /**
+     * @brief 以 serialize() 写出的流替换全部内容，O(n) / Replace the contents with a stream written by serialize(), O(n)
+     *
+     * 逐块读入，每块先向池预留该块的节点，按中序建链后与 assign_sorted 一样自底向上建树，
+     * 不做逐个查找与旋转。流视为不可信：格式错误、类型不符或键不严格升序时抛出
+     * std::runtime_error，原内容保持不变。
+     *
+     * Reads chunk by chunk, reserving each chunk's nodes from the pool up
+     * front, chains the nodes in order and builds the tree bottom-up as
+     * assign_sorted does, with no per-element descent or rotations. The
+     * stream is untrusted: a malformed stream, mismatched types or keys that
+     * are not strictly ascending throw std::runtime_error and leave the map
+     * unchanged.
+     */
+    template <typename Reader>
+    void deserialize(Reader& reader) {
+        pooled_detail::ChunkReader<Reader> in(reader);
+        std::uint64_t expected = in.header(pooled_detail::StreamKind::Map, PooledCodec<Key>::fixed_size,
+                                           PooledCodec<Value>::fixed_size);
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        NodeType* prev = nullptr;
+        std::size_t n = 0;
+        try {
+            while (in.next()) {
+                if (in.starts_chunk()) reserve(in.chunk_size());
+                Key key = PooledCodec<Key>::read(in);
+                Value value = PooledCodec<Value>::read(in);
+                if (prev && !comp_(prev->key, key))
+                    throw std::runtime_error("PooledMap::deserialize requires strictly ascending keys");
+                NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                                                 std::forward_as_tuple(std::move(key)),
+                                                                 std::forward_as_tuple(std::move(value)));
+                *tail = node;
+                tail = &node->right;
+                prev = node;
+                ++n;
+            }
+            if (n != expected) throw std::runtime_error("PooledMap::deserialize: element count mismatch");
+        } catch (...) {
+            recycle_chain(head);
+            throw;
+        }
+        clear();
+        adopt_chain(head, n);
+    }
+
+    // ---------- 有序区间查询 / Ordered range queries ----------
+
+    /**
+     * @brief 第一个不小于 key 的位置 / First element whose key is not less than key
+     *
+     * 单次自顶向下查找，O(log n)；不存在时返回 end()。
+     * One top-down descent, O(log n); returns end() if there is none.
+     */
+    iterator lower_bound(const Key& key) { return iterator(lower_bound_node(key), this); }
+    const_iterator lower_bound(const Key& key) const { return const_iterator(lower_bound_node(key), this); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator lower_bound(const K& key) { return iterator(lower_bound_node(key), this); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator lower_bound(const K& key) const { return const_iterator(lower_bound_node(key), this); }
+
+    /**
+     * @brief 第一个大于 key 的位置 / First element whose key is greater than key
+     */
+    iterator upper_bound(const Key& key) { return iterator(upper_bound_node(key), this); }
+    const_iterator upper_bound(const Key& key) const { return const_iterator(upper_bound_node(key), this); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    iterator upper_bound(const K& key) { return iterator(upper_bound_node(key), this); }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    const_iterator upper_bound(const K& key) const { return const_iterator(upper_bound_node(key), this); }
+
+    /**
+     * @brief 等于 key 的区间 [lower_bound, upper_bound) / Range of elements equal to key
+     */
+    std::pair<iterator, iterator> equal_range(const Key& key) {
+        return { lower_bound(key), upper_bound(key) };
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<iterator, iterator> equal_range(const K& key) {
+        return { lower_bound(key), upper_bound(key) };
+    }
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+        return { lower_bound(key), upper_bound(key) };
+    }
+
+    /**
+     * @brief 中序遍历 [lo, hi) 内的 key-value / Traverse key-value pairs in [lo, hi) in order
+     *
+     * 先下降一次定位 lo，再沿后继前进，总代价 O(log n + k)。
+     * 参数同 for_each：`(const Key&, Value&)`。
+     *
+     * Descends once to lo and then walks successors: O(log n + k) in total.
+     * Same callback parameters as for_each: `(const Key&, Value&)`.
+     */
+    template <typename Func>
+    void for_each_range(const Key& lo, const Key& hi, Func&& func) {
+        for_each_range_impl(lo, hi, func);
+    }
+
+    template <typename K, typename Func, typename C = Compare, typename = typename C::is_transparent>
+    void for_each_range(const K& lo, const K& hi, Func&& func) {
+        for_each_range_impl(lo, hi, func);
+    }
+
+    // ---------- 遍历 / Traversal ----------
+    /**
+     * @brief 中序遍历所有 key-value / Traverse all key-value in-order
+     *
+     * 接收一个 lambda，参数为 `(const Key&, Value&)`。
+     * Accepts a lambda with parameters `(const Key&, Value&)`.
+     */
+    template <typename Func>
+    void for_each(Func&& func) {
+        inorder_traverse(root, std::forward<Func>(func));
+    }
+
+    /// const 版本，参数为 `(const Key&, const Value&)` / Const overload with `(const Key&, const Value&)`
+    template <typename Func>
+    void for_each(Func&& func) const {
+        inorder_traverse(static_cast<const NodeType*>(root), std::forward<Func>(func));
+    }
+
+    // ---------- 并行批量操作 / Parallel bulk operations ----------
+
+    /**
+     * @brief 并行访问所有元素 / Visit every element in parallel
+     *
+     * 按树的上几层把树切成约 concurrency × 8 棵互不相交的子树（外加它们之间的分隔节点），
+     * 调用线程与执行器上的工作者动态领取子树，子树内按中序访问；执行器见 PooledParallel.hpp，
+     * 省略时每个工作者一个 std::thread。func 会被多个线程同时调用，元素之间无顺序保证；
+     * 遍历期间不得修改容器。元素较少时直接在调用线程上顺序访问。
+     *
+     * Cuts the tree along its top levels into about concurrency × 8 disjoint
+     * subtrees (plus the separator nodes between them), which the calling
+     * thread and the executor's workers claim dynamically and walk in order.
+     * See PooledParallel.hpp for executors; without one, each worker is a
+     * std::thread. func is called from several threads at once with no order
+     * across elements, and the map must not be modified meanwhile. Small maps
+     * are visited sequentially on the calling thread.
+     *
+     * @param concurrency 工作者数（含调用线程），0 为硬件线程数 / Workers including the caller, 0 for the hardware thread count
+     */
+    template <typename Func>
+    void parallel_for_each(Func&& func, std::size_t concurrency = 0) {
+        pooled_detail::ThreadExecutor executor;
+        parallel_traverse(root, func, executor, concurrency);
+    }
+
+    template <typename Func, typename Executor>
+    void parallel_for_each(Func&& func, Executor&& executor, std::size_t concurrency) {
+        parallel_traverse(root, func, executor, concurrency);
+    }
+
+    /// const 版本，参数为 `(const Key&, const Value&)` / Const overloads with `(const Key&, const Value&)`
+    template <typename Func>
+    void parallel_for_each(Func&& func, std::size_t concurrency = 0) const {
+        pooled_detail::ThreadExecutor executor;
+        parallel_traverse(static_cast<const NodeType*>(root), func, executor, concurrency);
+    }
+
+    template <typename Func, typename Executor>
+    void parallel_for_each(Func&& func, Executor&& executor, std::size_t concurrency) const {
+        parallel_traverse(static_cast<const NodeType*>(root), func, executor, concurrency);
+    }
+
+    /**
+     * @brief 并集、交集与差集 / Union, intersection and difference
+     *
+     * 返回新的映射，使用 a 的比较器与池策略，键相同时取 a 中的值；a 与 b 保持不变。
+     * 以较大一方的上几层节点为分界把键空间切成若干区间，各工作者在自己的区间内
+     * 同步归并两棵树并在本线程分配结果节点（ThreadLocalPoolPolicy 下即各用各的线程本地缓存），
+     * 最后把各区间的有序链首尾相接，像 assign_sorted 一样自底向上建树。
+     * 总计 O(|a| + |b|)，不做逐个查找与旋转。池策略未声明 concurrent_create 时
+     * （如 NodeArena 不是线程安全的），或元素很少时，在调用线程上完成。
+     *
+     * Return a new map with a's comparator and pool policy, taking a's value
+     * when a key is in both; a and b are left unchanged. The key space is cut
+     * into ranges at the top-level nodes of the larger map, and each worker
+     * merges both trees over its own ranges, allocating result nodes on its
+     * own thread (its own thread-local cache under ThreadLocalPoolPolicy).
+     * The sorted chains of the ranges are then joined end to end and the tree
+     * is built bottom-up as in assign_sorted. O(|a| + |b|) overall, with no
+     * per-element descent or rotations. Runs on the calling thread when the
+     * pool policy does not declare concurrent_create (NodeArena, for one, is
+     * not thread-safe) or the maps are small.
+     */
+    static PooledMap set_union(const PooledMap& a, const PooledMap& b, std::size_t concurrency = 0) {
+        pooled_detail::ThreadExecutor executor;
+        return set_operation<SetOp::Union>(a, b, executor, concurrency);
+    }
 
-        // 删除分支逻辑 / Different cases of deletion
-        if (!z->left) {
-            x = z->right;
-            x_parent = z->parent;
-            transplant(z, z->right);
-        } else if (!z->right) {
-            x = z->left;
-            x_parent = z->parent;
-            transplant(z, z->left);
-        } else {
-            y = minimum(z->right);
-            y_original_color = y->color;
-            x = y->right;
-            if (y->parent == z) {
-                if (x) x->parent = y;
-                x_parent = y;
-            } else {
-                transplant(y, y->right);
-                y->right = z->right;
-                y->right->parent = y;
-                x_parent = y->parent;
-            }
-            transplant(z, y);
-            y->left = z->left;
-            y->left->parent = y;
-            y->color = z->color;
-        }
+    template <typename Executor>
+    static PooledMap set_union(const PooledMap& a, const PooledMap& b, Executor&& executor, std::size_t concurrency) {
+        return set_operation<SetOp::Union>(a, b, executor, concurrency);
+    }
 
-        z->recycle();  // 回收节点到对象池 / Recycle node to object pool
-        --size_;
+    static PooledMap set_intersection(const PooledMap& a, const PooledMap& b, std::size_t concurrency = 0) {
+        pooled_detail::ThreadExecutor executor;
+        return set_operation<SetOp::Intersection>(a, b, executor, concurrency);
+    }
 
-        if (y_original_color == BLACK)
-            fix_erase(x, x_parent);
+    template <typename Executor>
+    static PooledMap set_intersection(const PooledMap& a, const PooledMap& b, Executor&& executor, std::size_t concurrency) {
+        return set_operation<SetOp::Intersection>(a, b, executor, concurrency);
+    }
 
-        return 1;
+    static PooledMap set_difference(const PooledMap& a, const PooledMap& b, std::size_t concurrency = 0) {
+        pooled_detail::ThreadExecutor executor;
+        return set_operation<SetOp::Difference>(a, b, executor, concurrency);
     }
 
-    /// 返回当前大小 / Return current size
-    std::size_t size() const noexcept { return size_; }
+    template <typename Executor>
+    static PooledMap set_difference(const PooledMap& a, const PooledMap& b, Executor&& executor, std::size_t concurrency) {
+        return set_operation<SetOp::Difference>(a, b, executor, concurrency);
+    }
 
-    /// 判断是否为空 / Check if empty
-    bool empty() const noexcept { return size_ == 0; }
+    // ---------- 顺序统计 / Order statistics ----------
 
     /**
-     * @brief 判断 key 是否存在 / Check if key exists
+     * @brief 第 k 小的元素（从 0 开始）/ The k-th smallest element, counting from 0
+     *
+     * 需要 OrderStatistic = true。沿子树大小下降，O(log n)；k >= size() 时返回 end()。
+     * Requires OrderStatistic = true. Descends by subtree sizes in O(log n);
+     * returns end() if k >= size().
      */
-    bool contains(const Key& key) const {
-        NodeType* cur = root;
-        while (cur) {
-            Key& k = cur->key;
-            if (key == k) return true;
-            cur = (key < k) ? cur->left : cur->right;
-        }
-        return false;
-    }
+    iterator nth(std::size_t k) { return iterator(nth_node(k), this); }
+    const_iterator nth(std::size_t k) const { return const_iterator(nth_node(k), this); }
 
-    // ---------- 对外唯一遍历方法 / Single public traversal method ----------
     /**
-     * @brief 中序遍历所有 key-value / Traverse all key-value in-order
+     * @brief 小于 key 的元素个数 / Number of elements whose key is less than key
      *
-     * 接收一个 lambda，参数为 `(const Key&, Value&)`。
-     * Accepts a lambda with parameters `(const Key&, Value&)`.
+     * 需要 OrderStatistic = true。单次下降，O(log n)；key 存在时即为它在有序序列中的下标。
+     * Requires OrderStatistic = true. One descent in O(log n); when key is
+     * present this is its index in sorted order.
      */
-    template <typename Func>
-    void for_each(Func&& func) {
-        inorder_traverse(root, std::forward<Func>(func));
-    }
+    std::size_t rank(const Key& key) const { return rank_impl(key); }
+
+    template <typename K, typename C = Compare, typename = typename C::is_transparent>
+    std::size_t rank(const K& key) const { return rank_impl(key); }
 
 private:
     // ---------- 内部定义 / Internal definitions ----------
-    enum Color { RED, BLACK };
+    enum Color { RED = 0, BLACK = 1 };
 
     /**
      * @brief 红黑树节点 / Red-black tree node
      *
-     * 使用 PooledObject 基类进行对象池化分配。
-     * Uses PooledObject base class for pooled allocation.
+     * 由 Pool 策略分配；默认策略下继承 PooledObject 基类进行对象池化分配。
+     * Allocated through the Pool policy; with the default policy it derives
+     * from PooledObject for pooled allocation.
      */
-    struct Node : public PooledObject<Node> {
+    struct Node : public Pool::template node_base<Node>, public pooled_detail::SubtreeCount<OrderStatistic> {
         Key key;
         Value value;
         Node* left = nullptr;
         Node* right = nullptr;
-        Node* parent = nullptr;
-        Color color = RED;
 
-        Node(const Key& k, const Value& v) : key(k), value(v) {}
+        // 父指针与颜色合并存放：节点至少按指针对齐，最低位空闲，用来存颜色（0 红 / 1 黑）
+        // Parent pointer and color share one word: nodes are pointer-aligned,
+        // so the low bit is free and holds the color (0 red / 1 black).
+        std::uintptr_t parent_color = 0;
+
+        Node* parent() const noexcept { return reinterpret_cast<Node*>(parent_color & ~std::uintptr_t(1)); }
+        void set_parent(Node* p) noexcept {
+            parent_color = reinterpret_cast<std::uintptr_t>(p) | (parent_color & std::uintptr_t(1));
+        }
+        Color color() const noexcept { return static_cast<Color>(parent_color & std::uintptr_t(1)); }
+        void set_color(Color c) noexcept {
+            parent_color = (parent_color & ~std::uintptr_t(1)) | static_cast<std::uintptr_t>(c);
+        }
+
+        template <typename K, typename V>
+        Node(K&& k, V&& v) : key(std::forward<K>(k)), value(std::forward<V>(v)) {}
+
+        template <typename A, typename B>
+        Node(const std::pair<A, B>& kv) : key(kv.first), value(kv.second) {}
+
+        template <typename A, typename B>
+        Node(std::pair<A, B>&& kv) : key(std::forward<A>(kv.first)), value(std::forward<B>(kv.second)) {}
+
+        // 分段构造 / Piecewise construction
+        template <typename KArgs, typename VArgs>
+        Node(std::piecewise_construct_t, KArgs&& kargs, VArgs&& vargs)
+            : key(std::make_from_tuple<Key>(std::forward<KArgs>(kargs))),
+              value(std::make_from_tuple<Value>(std::forward<VArgs>(vargs))) {}
     };
 
-    using NodeType = Node;
+    static_assert(alignof(Node) >= 2, "PooledMap packs the color into the parent pointer's low bit");
 
     NodeType* root = nullptr;      ///< 根节点 / Root node
     std::size_t size_ = 0;         ///< 节点数量 / Number of nodes
+    Compare comp_;                 ///< 键比较器 / Key comparator
+    Pool pool_;                    ///< 节点池策略 / Node pool policy
+    NodeType* retired_ = nullptr;  ///< compact_step 换下、待整轮结束归还的节点 / Nodes replaced by compact_step, returned when the pass ends
+#ifdef POOLED_CONTAINER_STATS
+    std::uint64_t rotations_ = 0;  ///< 累计旋转次数 / Rotations so far
+#endif
 
     // ---------- 红黑树内部操作 / Red-black tree internal operations ----------
 
+    // 子树大小维护，OrderStatistic 关闭时全部编译为空 / Subtree-size upkeep; compiles to nothing with OrderStatistic off
+    static std::size_t subtree_count(const NodeType* n) noexcept {
+        if constexpr (OrderStatistic) return n ? n->subtree_size : 0;
+        else return 0;
+    }
+
+    static void update_count(NodeType* n) noexcept {
+        if constexpr (OrderStatistic) n->subtree_size = subtree_count(n->left) + subtree_count(n->right) + 1;
+    }
+
     // 左旋 / Left rotation
     inline void rotate_left(NodeType* x) {
         NodeType* y = x->right;
         x->right = y->left;
-        if (y->left) y->left->parent = x;
-        y->parent = x->parent;
-        if (!x->parent) root = y;
-        else if (x == x->parent->left) x->parent->left = y;
-        else x->parent->right = y;
+        if (y->left) y->left->set_parent(x);
+        y->set_parent(x->parent());
+        if (!x->parent()) root = y;
+        else if (x == x->parent()->left) x->parent()->left = y;
+        else x->parent()->right = y;
         y->left = x;
-        x->parent = y;
+        x->set_parent(y);
+        if constexpr (OrderStatistic) {
+            y->subtree_size = x->subtree_size;
+            update_count(x);
+        }
+#ifdef POOLED_CONTAINER_STATS
+        ++rotations_;
+#endif
     }
 
     // 右旋 / Right rotation
     inline void rotate_right(NodeType* x) {
         NodeType* y = x->left;
         x->left = y->right;
-        if (y->right) y->right->parent = x;
-        y->parent = x->parent;
-        if (!x->parent) root = y;
-        else if (x == x->parent->right) x->parent->right = y;
-        else x->parent->left = y;
+        if (y->right) y->right->set_parent(x);
+        y->set_parent(x->parent());
+        if (!x->parent()) root = y;
+        else if (x == x->parent()->right) x->parent()->right = y;
+        else x->parent()->left = y;
         y->right = x;
-        x->parent = y;
+        x->set_parent(y);
+        if constexpr (OrderStatistic) {
+            y->subtree_size = x->subtree_size;
+            update_count(x);
+        }
+#ifdef POOLED_CONTAINER_STATS
+        ++rotations_;
+#endif
     }
 
     // 插入修复 / Fix properties after insertion
     inline void fix_insert(NodeType* z) {
-        while (z->parent && z->parent->color == RED) {
-            if (z->parent == z->parent->parent->left) {
-                NodeType* y = z->parent->parent->right;
-                if (y && y->color == RED) {
+        while (z->parent() && z->parent()->color() == RED) {
+            if (z->parent() == z->parent()->parent()->left) {
+                NodeType* y = z->parent()->parent()->right;
+                if (y && y->color() == RED) {
                     // Case 1: 叔叔为红色 / Uncle is red
-                    z->parent->color = BLACK;
-                    y->color = BLACK;
-                    z->parent->parent->color = RED;
-                    z = z->parent->parent;
+                    z->parent()->set_color(BLACK);
+                    y->set_color(BLACK);
+                    z->parent()->parent()->set_color(RED);
+                    z = z->parent()->parent();
                 } else {
-                    if (z == z->parent->right) {
+                    if (z == z->parent()->right) {
                         // Case 2: 内旋转 / Inner rotation
-                        z = z->parent;
+                        z = z->parent();
                         rotate_left(z);
                     }
                     // Case 3: 外旋转 / Outer rotation
-                    z->parent->color = BLACK;
-                    z->parent->parent->color = RED;
-                    rotate_right(z->parent->parent);
+                    z->parent()->set_color(BLACK);
+                    z->parent()->parent()->set_color(RED);
+                    rotate_right(z->parent()->parent());
                 }
             } else {
-                NodeType* y = z->parent->parent->left;
-                if (y && y->color == RED) {
-                    z->parent->color = BLACK;
-                    y->color = BLACK;
-                    z->parent->parent->color = RED;
-                    z = z->parent->parent;
+                NodeType* y = z->parent()->parent()->left;
+                if (y && y->color() == RED) {
+                    z->parent()->set_color(BLACK);
+                    y->set_color(BLACK);
+                    z->parent()->parent()->set_color(RED);
+                    z = z->parent()->parent();
                 } else {
-                    if (z == z->parent->left) {
-                        z = z->parent;
+                    if (z == z->parent()->left) {
+                        z = z->parent();
                         rotate_right(z);
                     }
-                    z->parent->color = BLACK;
-                    z->parent->parent->color = RED;
-                    rotate_left(z->parent->parent);
+                    z->parent()->set_color(BLACK);
+                    z->parent()->parent()->set_color(RED);
+                    rotate_left(z->parent()->parent());
                 }
             }
         }
-        root->color = BLACK;
+        root->set_color(BLACK);
     }
 
     // 删除修复 / Fix properties after deletion
     inline void fix_erase(NodeType* x, NodeType* x_parent) {
-        while (x != root && (!x || x->color == BLACK)) {
+        while (x != root && (!x || x->color() == BLACK)) {
             if (x == x_parent->left) {
                 NodeType* w = x_parent->right;
-                if (w && w->color == RED) {
+                if (w && w->color() == RED) {
                     // Case 1: 兄弟为红色 / Sibling is red
-                    w->color = BLACK;
-                    x_parent->color = RED;
+                    w->set_color(BLACK);
+                    x_parent->set_color(RED);
                     rotate_left(x_parent);
                     w = x_parent->right;
                 }
-                if ((!w->left || w->left->color == BLACK) && (!w->right || w->right->color == BLACK)) {
+                if ((!w->left || w->left->color() == BLACK) && (!w->right || w->right->color() == BLACK)) {
                     // Case 2: 两个子节点都是黑色 / Both children black
-                    w->color = RED;
+                    w->set_color(RED);
                     x = x_parent;
-                    x_parent = x->parent;
+                    x_parent = x->parent();
                 } else {
-                    if (!w->right || w->right->color == BLACK) {
-                        if (w->left) w->left->color = BLACK;
-                        w->color = RED;
+                    if (!w->right || w->right->color() == BLACK) {
+                        if (w->left) w->left->set_color(BLACK);
+                        w->set_color(RED);
                         rotate_right(w);
                         w = x_parent->right;
                     }
                     // Case 3: 修复并旋转 / Fix and rotate
-                    w->color = x_parent->color;
-                    x_parent->color = BLACK;
-                    if (w->right) w->right->color = BLACK;
+                    w->set_color(x_parent->color());
+                    x_parent->set_color(BLACK);
+                    if (w->right) w->right->set_color(BLACK);
                     rotate_left(x_parent);
                     x = root;
                 }
             } else {
                 NodeType* w = x_parent->left;
-                if (w && w->color == RED) {
-                    w->color = BLACK;
-                    x_parent->color = RED;
+                if (w && w->color() == RED) {
+                    w->set_color(BLACK);
+                    x_parent->set_color(RED);
                     rotate_right(x_parent);
                     w = x_parent->left;
                 }
-                if ((!w->right || w->right->color == BLACK) && (!w->left || w->left->color == BLACK)) {
-                    w->color = RED;
+                if ((!w->right || w->right->color() == BLACK) && (!w->left || w->left->color() == BLACK)) {
+                    w->set_color(RED);
                     x = x_parent;
-                    x_parent = x->parent;
+                    x_parent = x->parent();
                 } else {
-                    if (!w->left || w->left->color == BLACK) {
-                        if (w->right) w->right->color = BLACK;
-                        w->color = RED;
+                    if (!w->left || w->left->color() == BLACK) {
+                        if (w->right) w->right->set_color(BLACK);
+                        w->set_color(RED);
                         rotate_left(w);
                         w = x_parent->left;
                     }
-                    w->color = x_parent->color;
-                    x_parent->color = BLACK;
-                    if (w->left) w->left->color = BLACK;
+                    w->set_color(x_parent->color());
+                    x_parent->set_color(BLACK);
+                    if (w->left) w->left->set_color(BLACK);
                     rotate_right(x_parent);
                     x = root;
                 }
             }
         }
-        if (x) x->color = BLACK;
+        if (x) x->set_color(BLACK);
+    }
+
+    // ---------- 查找与插入 / Lookup and insertion ----------
+    //
+    // 每层只做一次 comp_(node, key) 比较：向左时记录候选节点，
+    // 到底后再用一次 comp_(key, candidate) 判断相等，
+    // 避免旧实现 `==` 加 `<` 每层两次比较（对字符串键即两次字符串比较）。
+    //
+    // One comp_(node, key) call per level: remember the candidate when going
+    // left, then a single comp_(key, candidate) at the bottom decides equality.
+    // The former `==` followed by `<` cost two (string) comparisons per level.
+
+    // 第一个 key >= k 的节点 / First node with key >= k
+    template <typename K>
+    NodeType* lower_bound_node(const K& key) const {
+        NodeType* cur = root;
+        NodeType* result = nullptr;
+        while (cur) {
+            if (comp_(cur->key, key)) cur = cur->right;
+            else { result = cur; cur = cur->left; }
+        }
+        return result;
+    }
+
+    // 第一个 key > k 的节点 / First node with key > k
+    template <typename K>
+    NodeType* upper_bound_node(const K& key) const {
+        NodeType* cur = root;
+        NodeType* result = nullptr;
+        while (cur) {
+            if (comp_(key, cur->key)) { result = cur; cur = cur->left; }
+            else cur = cur->right;
+        }
+        return result;
+    }
+
+    // 精确查找 / Exact match
+    template <typename K>
+    NodeType* find_node(const K& key) const {
+        NodeType* node = lower_bound_node(key);
+        return (node && !comp_(key, node->key)) ? node : nullptr;
+    }
+
+    // 插入位置：命中时 match 非空 / Insertion slot; match is set on a hit
+    struct InsertPos {
+        NodeType* parent;
+        NodeType* match;
+        bool left;
+    };
+
+    template <typename K>
+    InsertPos find_insert_pos(const K& key) const {
+        NodeType* cur = root;
+        NodeType* parent = nullptr;
+        NodeType* candidate = nullptr;
+        bool go_left = false;
+        while (cur) {
+            parent = cur;
+            go_left = !comp_(cur->key, key);
+            if (go_left) { candidate = cur; cur = cur->left; }
+            else cur = cur->right;
+        }
+        if (candidate && !comp_(key, candidate->key)) return { parent, candidate, go_left };
+        return { parent, nullptr, go_left };
+    }
+
+    // 挂接新节点并修复 / Link a fresh node at the slot and rebalance
+    void link_node(NodeType* node, const InsertPos& pos) {
+        node->left = node->right = nullptr;
+        node->set_color(RED);
+        node->set_parent(pos.parent);
+
+        if (!pos.parent) root = node;
+        else if (pos.left) pos.parent->left = node;
+        else pos.parent->right = node;
+
+        if constexpr (OrderStatistic) {
+            node->subtree_size = 1;
+            for (NodeType* p = pos.parent; p; p = p->parent()) ++p->subtree_size;
+        }
+
+        // 红黑树插入修复 / Fix RB-tree property after insert
+        fix_insert(node);
+        ++size_;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<NodeType*, bool> try_emplace_node(K&& key, Args&&... args) {
+        InsertPos pos = find_insert_pos(key);
+        if (pos.match) return { pos.match, false };
+
+        // 创建新节点，key 与 value 均在池内存中原位构造 / Build key and value in place in pool memory
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<Args>(args)...));
+        link_node(node, pos);
+        return { node, true };
+    }
+
+    template <typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& obj) {
+        InsertPos pos = find_insert_pos(key);
+        if (pos.match) {
+            pos.match->value = std::forward<M>(obj);
+            return { iterator(pos.match, this), false };
+        }
+        NodeType* node = pool_.template create<NodeType>(std::piecewise_construct,
+                                          std::forward_as_tuple(std::forward<K>(key)),
+                                          std::forward_as_tuple(std::forward<M>(obj)));
+        link_node(node, pos);
+        return { iterator(node, this), true };
+    }
+
+    template <typename N, typename Func>
+    static bool visit_node(N* node, Func& func) {
+        if (!node) return false;
+        func(node->value);
+        return true;
+    }
+
+    // 批量查找的分组大小：足以覆盖内存延迟，状态仍能留在寄存器与 L1 中
+    // Batch group size: enough lookups in flight to cover memory latency while the state stays in registers / L1
+    static constexpr std::size_t batch_group = 16;
+
+    // 分组同步下降，每层比较方式与 lower_bound_node 相同 / Lockstep grouped descent, one comparison per level as in lower_bound_node
+    template <typename K, typename Emit>
+    void find_batch_impl(const K* keys, std::size_t n, Emit&& emit) const {
+        NodeType* cur[batch_group];
+        NodeType* candidate[batch_group];
+        for (std::size_t base = 0; base < n; base += batch_group) {
+            std::size_t g = std::min(batch_group, n - base);
+            for (std::size_t j = 0; j < g; ++j) {
+                cur[j] = root;
+                candidate[j] = nullptr;
+            }
+            for (bool active = root != nullptr; active;) {
+                active = false;
+                for (std::size_t j = 0; j < g; ++j) {
+                    NodeType* node = cur[j];
+                    if (!node) continue;
+                    if (comp_(node->key, keys[base + j])) node = node->right;
+                    else { candidate[j] = node; node = node->left; }
+                    cur[j] = node;
+                    if (node) {
+                        POOLED_PREFETCH(node);
+                        active = true;
+                    }
+                }
+            }
+            for (std::size_t j = 0; j < g; ++j) {
+                NodeType* c = candidate[j];
+                emit(base + j, (c && !comp_(keys[base + j], c->key)) ? c : nullptr);
+            }
+        }
+    }
+
+    template <typename K, typename Func>
+    void for_each_range_impl(const K& lo, const K& hi, Func& func) {
+        for (NodeType* cur = lower_bound_node(lo); cur && comp_(cur->key, hi); cur = successor(cur)) {
+            func(cur->key, cur->value);
+        }
+    }
+
+    NodeType* nth_node(std::size_t k) const noexcept {
+        static_assert(OrderStatistic, "PooledMap::nth requires OrderStatistic = true");
+        NodeType* cur = root;
+        while (cur) {
+            std::size_t left = subtree_count(cur->left);
+            if (k < left) cur = cur->left;
+            else if (k == left) return cur;
+            else {
+                k -= left + 1;
+                cur = cur->right;
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename K>
+    std::size_t rank_impl(const K& key) const {
+        static_assert(OrderStatistic, "PooledMap::rank requires OrderStatistic = true");
+        std::size_t r = 0;
+        for (NodeType* cur = root; cur;) {
+            if (comp_(cur->key, key)) {
+                r += subtree_count(cur->left) + 1;
+                cur = cur->right;
+            } else {
+                cur = cur->left;
+            }
+        }
+        return r;
+    }
+
+    // 删除节点并修复 / Unlink a node, rebalance and recycle it
+    std::size_t erase_node(NodeType* z) {
+        if (!z) return 0;
+        unlink_node(z);
+        pool_.recycle(z);  // 回收节点到对象池 / Recycle node to object pool
+        return 1;
+    }
+
+    // 从树中摘下节点并修复，不回收 / Unlink a node from the tree and rebalance, without recycling it
+    void unlink_node(NodeType* z) {
+        if constexpr (OrderStatistic) {
+            // 实际离开原位置的是 z，或有两个孩子时顶替它的后继 / The node leaving its slot is z, or its successor when z has two children
+            NodeType* moved = (z->left && z->right) ? minimum(z->right) : z;
+            for (NodeType* p = moved->parent(); p; p = p->parent()) --p->subtree_size;
+        }
+
+        NodeType* y = z;
+        Color y_original_color = y->color();
+        NodeType* x = nullptr;
+        NodeType* x_parent = nullptr;
+
+        // 删除分支逻辑 / Different cases of deletion
+        if (!z->left) {
+            x = z->right;
+            x_parent = z->parent();
+            transplant(z, z->right);
+        } else if (!z->right) {
+            x = z->left;
+            x_parent = z->parent();
+            transplant(z, z->left);
+        } else {
+            y = minimum(z->right);
+            y_original_color = y->color();
+            x = y->right;
+            if (y->parent() == z) {
+                if (x) x->set_parent(y);
+                x_parent = y;
+            } else {
+                transplant(y, y->right);
+                y->right = z->right;
+                y->right->set_parent(y);
+                x_parent = y->parent();
+            }
+            transplant(z, y);
+            y->left = z->left;
+            y->left->set_parent(y);
+            y->set_color(z->color());
+            if constexpr (OrderStatistic) y->subtree_size = z->subtree_size;
+        }
+
+        --size_;
+
+        if (y_original_color == BLACK)
+            fix_erase(x, x_parent);
     }
 
     // 查找最小节点 / Find minimum node
-    NodeType* minimum(NodeType* node) const {
+    template <typename N>
+    static N* minimum(N* node) noexcept {
         while (node->left) node = node->left;
         return node;
     }
 
+    // 查找最大节点 / Find maximum node
+    template <typename N>
+    static N* maximum(N* node) noexcept {
+        while (node->right) node = node->right;
+        return node;
+    }
+
+    // 中序后继 / In-order successor
+    template <typename N>
+    static N* successor(N* node) noexcept {
+        if (node->right) return minimum(node->right);
+        N* p = node->parent();
+        while (p && node == p->right) {
+            node = p;
+            p = p->parent();
+        }
+        return p;
+    }
+
+    // 中序前驱 / In-order predecessor
+    template <typename N>
+    static N* predecessor(N* node) noexcept {
+        if (node->left) return maximum(node->left);
+        N* p = node->parent();
+        while (p && node == p->left) {
+            node = p;
+            p = p->parent();
+        }
+        return p;
+    }
+
     // 子树替换 / Subtree transplant
     inline void transplant(NodeType* u, NodeType* v) {
-        if (!u->parent) root = v;
-        else if (u == u->parent->left) u->parent->left = v;
-        else u->parent->right = v;
-        if (v) v->parent = u->parent;
+        if (!u->parent()) root = v;
+        else if (u == u->parent()->left) u->parent()->left = v;
+        else u->parent()->right = v;
+        if (v) v->set_parent(u->parent());
+    }
+
+    // ---------- 批量构造 / Bulk construction ----------
+
+    struct sorted_tag {};
+
+    template <typename ForwardIt>
+    PooledMap(sorted_tag, ForwardIt first, ForwardIt last, const Compare& comp, const Pool& pool)
+        : comp_(comp), pool_(pool) {
+        assign_sorted(first, last);
+    }
+
+    // 回收以 right 串起的节点链 / Recycle a chain linked through right
+    void recycle_chain(NodeType* head) noexcept {
+        while (head) {
+            NodeType* next = head->right;
+            pool_.recycle(head);
+            head = next;
+        }
+    }
+
+    // 以升序节点链（经 right 串联）作为全部内容，map 须为空 / Adopt an ascending chain as the whole tree; map must be empty
+    void adopt_chain(NodeType* head, std::size_t n) noexcept {
+        root = build_from_chain(head, n, 0, balanced_red_depth(n));
+        if (root) root->set_parent(nullptr);
+        size_ = n;
+    }
+
+    // 深度 floor(log2(n+1)) 为不满的最底层 / depth floor(log2(n+1)) is the incomplete bottom level
+    static std::size_t balanced_red_depth(std::size_t n) noexcept {
+        std::size_t red_depth = 0;
+        while ((std::size_t(2) << red_depth) <= n + 1) ++red_depth;
+        return red_depth;
+    }
+
+    // 右旋展平为经 right 串联的升序链，O(n)、无额外空间；parent 与颜色作废，由 adopt_chain 重建
+    // Flatten into an ascending chain through right by right rotations, O(n) with no extra space;
+    // parents and colors become stale until adopt_chain rebuilds them
+    static NodeType* flatten(NodeType* node) noexcept {
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        while (node) {
+            if (NodeType* l = node->left) {
+                node->left = l->right;
+                l->right = node;
+                node = l;
+            } else {
+                *tail = node;
+                tail = &node->right;
+                node = node->right;
+            }
+        }
+        return head;
+    }
+
+    // 左右子树大小至多差 1，所有外部节点深度相差不超过 1 / Subtree sizes differ by at most one
+    static NodeType* build_from_chain(NodeType*& head, std::size_t n, std::size_t depth, std::size_t red_depth) noexcept {
+        if (n == 0) return nullptr;
+        std::size_t nl = (n - 1) / 2;
+        NodeType* left = build_from_chain(head, nl, depth + 1, red_depth);
+        NodeType* node = head;
+        head = head->right;
+        node->left = left;
+        if (left) left->set_parent(node);
+        node->right = build_from_chain(head, n - 1 - nl, depth + 1, red_depth);
+        if (node->right) node->right->set_parent(node);
+        node->set_color((depth == red_depth) ? RED : BLACK);
+        if constexpr (OrderStatistic) node->subtree_size = n;
+        return node;
+    }
+
+    // 同 build_from_chain，节点取自按中序排列的数组 / Same as build_from_chain, taking nodes from an in-order array
+    static NodeType* build_from_array(NodeType* const* nodes, std::size_t n, std::size_t depth, std::size_t red_depth) noexcept {
+        if (n == 0) return nullptr;
+        std::size_t nl = (n - 1) / 2;
+        NodeType* node = nodes[nl];
+        node->left = build_from_array(nodes, nl, depth + 1, red_depth);
+        if (node->left) node->left->set_parent(node);
+        node->right = build_from_array(nodes + nl + 1, n - 1 - nl, depth + 1, red_depth);
+        if (node->right) node->right->set_parent(node);
+        node->set_color((depth == red_depth) ? RED : BLACK);
+        if constexpr (OrderStatistic) node->subtree_size = n;
+        return node;
+    }
+
+    // ---------- 节点整理 / Compaction ----------
+
+    // 键值都能无异常移动时移动，否则复制，搬移中途失败时可以复原 / Move when neither key nor value can throw, else copy, so a failed relocation can be undone
+    static constexpr bool relocate_by_move =
+        (std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_assignable_v<Key> &&
+         std::is_nothrow_move_constructible_v<Value> && std::is_nothrow_move_assignable_v<Value>) ||
+        !std::is_copy_constructible_v<Key> || !std::is_copy_constructible_v<Value>;
+
+    // 分配失败时键值尚未搬出，原节点不变 / If allocation fails nothing has been moved out yet
+    NodeType* relocated_copy(NodeType* n) {
+        if constexpr (relocate_by_move) {
+            return pool_.template create<NodeType>(std::piecewise_construct,
+                                                   std::forward_as_tuple(std::move(n->key)),
+                                                   std::forward_as_tuple(std::move(n->value)));
+        } else {
+            return pool_.template create<NodeType>(std::piecewise_construct,
+                                                   std::forward_as_tuple(n->key),
+                                                   std::forward_as_tuple(n->value));
+        }
+    }
+
+    // 把已搬出的键值移回原节点 / Move relocated keys and values back into the original nodes
+    static void restore_relocated(NodeType* from, NodeType* to) {
+        if constexpr (relocate_by_move) {
+            to->key = std::move(from->key);
+            to->value = std::move(from->value);
+        }
+    }
+
+    // fresh 就地顶替 old：接管父子链接、颜色与子树大小 / fresh takes old's place: links, color and subtree size
+    void replace_node(NodeType* old, NodeType* fresh) noexcept {
+        fresh->left = old->left;
+        fresh->right = old->right;
+        fresh->parent_color = old->parent_color;
+        if constexpr (OrderStatistic) fresh->subtree_size = old->subtree_size;
+        if (fresh->left) fresh->left->set_parent(fresh);
+        if (fresh->right) fresh->right->set_parent(fresh);
+        NodeType* p = old->parent();
+        if (!p) root = fresh;
+        else if (p->left == old) p->left = fresh;
+        else p->right = fresh;
+    }
+
+    void flush_retired() noexcept {
+        recycle_chain(retired_);
+        retired_ = nullptr;
+    }
+
+    void compact_in_order() {
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        try {
+            for (NodeType* cur = minimum(root); cur; cur = successor(cur)) {
+                NodeType* node = relocated_copy(cur);
+                *tail = node;
+                tail = &node->right;
+            }
+        } catch (...) {
+            NodeType* old = minimum(root);
+            for (NodeType* n = head; n; n = n->right, old = successor(old)) restore_relocated(n, old);
+            recycle_chain(head);
+            throw;
+        }
+        std::size_t n = size_;
+        clear(root);
+        adopt_chain(head, n);
+    }
+
+    void compact_veb() {
+        std::vector<NodeType*> old;
+        old.reserve(size_);
+        for (NodeType* cur = minimum(root); cur; cur = successor(cur)) old.push_back(cur);
+        std::vector<NodeType*> fresh(size_, nullptr);
+
+        // 完全平衡树的高度：右子树总是较大的一侧 / Height of the balanced tree: the right subtree is never smaller
+        std::size_t height = 0;
+        for (std::size_t m = size_; m; m -= 1 + (m - 1) / 2) ++height;
+
+        try {
+            auto relocate = [&](std::size_t rank) { fresh[rank] = relocated_copy(old[rank]); };
+            veb_visit(0, size_, height, relocate);
+        } catch (...) {
+            for (std::size_t i = 0; i < size_; ++i) {
+                if (!fresh[i]) continue;
+                restore_relocated(fresh[i], old[i]);
+                pool_.recycle(fresh[i]);
+            }
+            throw;
+        }
+        clear(root);
+        root = build_from_array(fresh.data(), size_, 0, balanced_red_depth(size_));
+        root->set_parent(nullptr);
+    }
+
+    // 按 van Emde Boas 顺序访问平衡树（形状同 build_from_chain，中序编号 [lo, lo + n)）的前 h 层：
+    // 先递归访问上半部分，再依次递归访问挂在其下的各棵子树
+    // Visit the top h levels of the balanced tree over in-order ranks [lo, lo + n)
+    // (shaped like build_from_chain) in van Emde Boas order: the top half
+    // recursively, then each subtree hanging below it in turn
+    template <typename Visit>
+    static void veb_visit(std::size_t lo, std::size_t n, std::size_t h, Visit& visit) {
+        if (n == 0 || h == 0) return;
+        if (h == 1) {
+            visit(lo + (n - 1) / 2);
+            return;
+        }
+        std::size_t top = h / 2;
+        veb_visit(lo, n, top, visit);
+        veb_subtrees(lo, n, top, h - top, visit);
+    }
+
+    // 访问深度 depth 处的每棵子树的前 h 层 / Visit the top h levels of every subtree at depth depth
+    template <typename Visit>
+    static void veb_subtrees(std::size_t lo, std::size_t n, std::size_t depth, std::size_t h, Visit& visit) {
+        if (n == 0) return;
+        if (depth == 0) {
+            veb_visit(lo, n, h, visit);
+            return;
+        }
+        std::size_t nl = (n - 1) / 2;
+        veb_subtrees(lo, nl, depth - 1, h, visit);
+        veb_subtrees(lo + nl + 1, n - 1 - nl, depth - 1, h, visit);
     }
 
     // 清空节点 / Clear all nodes
     void clear(NodeType* node) {
-        if (!node) return;
-        clear(node->left);
-        clear(node->right);
-        node->recycle();
+        destroy_subtree(node, [this](NodeType* n) { pool_.recycle(n); });
     }
 
-    // 内部递归遍历 / Internal inorder traversal
-    template <typename Func>
-    void inorder_traverse(NodeType* node, Func&& func) {
+    // 后序处理子树中的每个节点 / Post-order visit that disposes of every node in a subtree
+    //
+    // 迭代实现，借助 parent 指针回溯，额外空间 O(1)；边处理边摘除叶子，
+    // 每条边最多下行、上行各一次，总计 O(n)，退化树也不会栈溢出。
+    //
+    // Iterative, climbing back through parent pointers with O(1) extra space.
+    // Leaves are detached as they are disposed of, so every edge is walked
+    // down and up at most once: O(n) total, and no stack overflow on
+    // degenerate trees.
+    template <typename Dispose>
+    static void destroy_subtree(NodeType* node, Dispose&& dispose) {
+        NodeType* cur = node;
+        while (cur) {
+            if (cur->left) { cur = cur->left; continue; }
+            if (cur->right) { cur = cur->right; continue; }
+            NodeType* parent = cur->parent();
+            bool last = (cur == node);
+            if (!last) {
+                if (parent->left == cur) parent->left = nullptr;
+                else parent->right = nullptr;
+            }
+            dispose(cur);
+            cur = last ? nullptr : parent;
+        }
+    }
+
+    // ---------- 并行批量操作 / Parallel bulk operations ----------
+
+    // 少于此数的元素不值得分发 / Below this many elements parallel dispatch does not pay off
+    static constexpr std::size_t parallel_grain = 4096;
+
+    // 每个工作者约 8 个任务，兼顾均衡与调度开销 / About 8 tasks per worker, balancing load against dispatch cost
+    static std::size_t split_depth(std::size_t workers) noexcept {
+        std::size_t depth = 0;
+        while ((std::size_t(1) << depth) < workers * 8) ++depth;
+        return depth;
+    }
+
+    // 收集深度 depth 处的子树（whole 为 true）与其上方的分隔节点，按中序排列
+    // Collect the subtrees at depth depth (whole = true) and the separator nodes above them, in order
+    template <typename N>
+    static void split_subtrees(N* node, std::size_t depth, std::vector<std::pair<N*, bool>>& out) {
         if (!node) return;
-        inorder_traverse(node->left, func);
-        func(node->key, node->value);
-        inorder_traverse(node->right, func);
+        if (depth == 0) {
+            out.emplace_back(node, true);
+            return;
+        }
+        split_subtrees(static_cast<N*>(node->left), depth - 1, out);
+        out.emplace_back(node, false);
+        split_subtrees(static_cast<N*>(node->right), depth - 1, out);
+    }
+
+    template <typename N, typename Func, typename Executor>
+    void parallel_traverse(N* node, Func& func, Executor& executor, std::size_t concurrency) const {
+        std::size_t workers = pooled_detail::resolve_concurrency(concurrency);
+        if (workers == 1 || size_ < parallel_grain) {
+            inorder_traverse(node, func);
+            return;
+        }
+        std::vector<std::pair<N*, bool>> tasks;
+        split_subtrees(node, split_depth(workers), tasks);
+        auto body = [&tasks, &func](std::size_t i) {
+            N* sub = tasks[i].first;
+            if (!tasks[i].second) {
+                func(sub->key, sub->value);
+                return;
+            }
+            for (N* cur = minimum(sub), *last = maximum(sub);; cur = successor(cur)) {
+                func(cur->key, cur->value);
+                if (cur == last) break;
+            }
+        };
+        pooled_detail::parallel_run(tasks.size(), workers, executor, body);
+    }
+
+    enum class SetOp { Union, Intersection, Difference };
+
+    // 以 right 串联的结果链 / Result chain linked through right
+    struct Chain {
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        std::size_t count = 0;
+    };
+
+    // 归并 a、b 中键位于 [lo, hi) 的部分，lo / hi 为空表示无界 / Merge the parts of a and b with keys in [lo, hi); a null bound is open
+    template <SetOp Op>
+    static void merge_range(const PooledMap& a, const PooledMap& b, PooledMap& out,
+                            const NodeType* lo, const NodeType* hi, Chain& chain) {
+        const Compare& comp = a.comp_;
+        auto first = [lo](const PooledMap& m) -> NodeType* {
+            if (lo) return m.lower_bound_node(lo->key);
+            return m.root ? minimum(m.root) : nullptr;
+        };
+        auto below = [hi, &comp](const NodeType* n) { return n && (!hi || comp(n->key, hi->key)); };
+        auto emit = [&out, &chain](const NodeType* src) {
+            NodeType* node = out.pool_.template create<NodeType>(std::piecewise_construct,
+                                                                 std::forward_as_tuple(src->key),
+                                                                 std::forward_as_tuple(src->value));
+            *chain.tail = node;
+            chain.tail = &node->right;
+            ++chain.count;
+        };
+
+        NodeType* x = first(a);
+        NodeType* y = first(b);
+        while (below(x) && below(y)) {
+            if (comp(x->key, y->key)) {
+                if constexpr (Op != SetOp::Intersection) emit(x);
+                x = successor(x);
+            } else if (comp(y->key, x->key)) {
+                if constexpr (Op == SetOp::Union) emit(y);
+                y = successor(y);
+            } else {
+                if constexpr (Op != SetOp::Difference) emit(x);
+                x = successor(x);
+                y = successor(y);
+            }
+        }
+        if constexpr (Op != SetOp::Intersection) {
+            for (; below(x); x = successor(x)) emit(x);
+        }
+        if constexpr (Op == SetOp::Union) {
+            for (; below(y); y = successor(y)) emit(y);
+        }
+    }
+
+    template <SetOp Op, typename Executor>
+    static PooledMap set_operation(const PooledMap& a, const PooledMap& b, Executor& executor, std::size_t concurrency) {
+        PooledMap out(a.comp_, a.pool_);
+        std::size_t workers = pooled_detail::resolve_concurrency(concurrency);
+        if (!pooled_detail::supports_concurrent_create<Pool>::value || a.size_ + b.size_ < parallel_grain) workers = 1;
+
+        // 较大一方上几层的节点作分界 / Range bounds are the top-level nodes of the larger map
+        std::vector<std::pair<NodeType*, bool>> split;
+        if (workers > 1) split_subtrees(a.size_ >= b.size_ ? a.root : b.root, split_depth(workers), split);
+        std::vector<const NodeType*> bounds;
+        for (const auto& s : split) {
+            if (!s.second) bounds.push_back(s.first);
+        }
+
+        std::vector<Chain> chains(bounds.size() + 1);
+        auto body = [&](std::size_t i) {
+            Chain& chain = chains[i];
+            chain.tail = &chain.head;
+            merge_range<Op>(a, b, out, i ? bounds[i - 1] : nullptr, i < bounds.size() ? bounds[i] : nullptr, chain);
+        };
+        try {
+            pooled_detail::parallel_run(chains.size(), workers, executor, body);
+        } catch (...) {
+            for (Chain& c : chains) out.recycle_chain(c.head);
+            throw;
+        }
+
+        NodeType* head = nullptr;
+        NodeType** tail = &head;
+        std::size_t n = 0;
+        for (Chain& c : chains) {
+            if (!c.head) continue;
+            *tail = c.head;
+            tail = c.tail;
+            n += c.count;
+        }
+        out.adopt_chain(head, n);
+        return out;
+    }
+
+    // 内部中序遍历：沿后继迭代，额外空间 O(1) / Internal in-order traversal along successors, O(1) extra space
+    template <typename N, typename Func>
+    static void inorder_traverse(N* node, Func&& func) {
+        for (N* cur = node ? minimum(node) : nullptr; cur; cur = successor(cur)) {
+            func(cur->key, cur->value);
+        }
     }
 };
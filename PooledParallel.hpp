@@ -0,0 +1,146 @@
+//
+//  PooledParallel.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  并行批量操作的执行层 / Execution layer for parallel bulk operations
+//  -----------------------------------------------------------------------------
+//
+//  容器把工作切成若干互不相交的任务，parallel_run 让调用线程与 concurrency - 1 个
+//  提交给执行器的工作者从同一个原子计数器动态领取任务（先做完的继续领，负载自动均衡），
+//  全部结束后返回；任一任务抛出的第一个异常在结束后重新抛出。
+//
+//  执行器是任意可调用对象 `executor(job)`，job 为可拷贝的 `void()` 任务，
+//  执行器须让它在其他线程上与调用者并发运行（如投递到线程池、TBB task_group::run、
+//  asio::post）；不能推迟到调用线程返回之后才执行，否则调用者会一直等待。
+//  未指定执行器时使用 ThreadExecutor，每个工作者一个 std::thread。
+//
+//  Containers cut the work into disjoint tasks; parallel_run has the calling
+//  thread and concurrency - 1 workers submitted to the executor claim tasks
+//  from one atomic counter (whoever finishes first claims the next, which
+//  balances the load), and returns once all are done. The first exception
+//  thrown by any task is rethrown at the end.
+//
+//  An executor is any callable `executor(job)` taking a copyable `void()`
+//  job, which it must run on another thread concurrently with the caller
+//  (e.g. a thread-pool submit, TBB task_group::run, asio::post). It must not
+//  defer the job until the calling thread returns, or the caller waits
+//  forever. Without an executor, ThreadExecutor runs one std::thread per worker.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pooled_detail {
+
+/// 默认执行器：每个任务一个 std::thread，析构时 join / Default executor: one std::thread per job, joined on destruction
+class ThreadExecutor {
+public:
+    ThreadExecutor() = default;
+    ThreadExecutor(const ThreadExecutor&) = delete;
+    ThreadExecutor& operator=(const ThreadExecutor&) = delete;
+
+    ~ThreadExecutor() {
+        for (std::thread& t : threads_) t.join();
+    }
+
+    template <typename Job>
+    void operator()(Job&& job) { threads_.emplace_back(std::forward<Job>(job)); }
+
+private:
+    std::vector<std::thread> threads_;
+};
+
+/// concurrency 为 0 时取硬件线程数 / Hardware thread count when concurrency is 0
+inline std::size_t resolve_concurrency(std::size_t concurrency) noexcept {
+    if (concurrency) return concurrency;
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+/**
+ * @brief 在调用线程与执行器上并行执行 body(0) .. body(tasks - 1) / Run body(0) .. body(tasks - 1) on the caller and the executor
+ *
+ * 见文件头说明；某个任务抛出后其余工作者不再领取新任务。
+ * See the file header; once a task throws, no worker claims further tasks.
+ */
+template <typename Executor, typename Body>
+void parallel_run(std::size_t tasks, std::size_t concurrency, Executor& executor, Body& body) {
+    struct State {
+        std::atomic<std::size_t> next{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::size_t running = 0;
+        std::exception_ptr error;
+    } st;
+
+    auto work = [&st, &body, tasks]() noexcept {
+        try {
+            for (std::size_t i; !st.failed.load(std::memory_order_relaxed) &&
+                                (i = st.next.fetch_add(1, std::memory_order_relaxed)) < tasks;)
+                body(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(st.mutex);
+            if (!st.error) st.error = std::current_exception();
+            st.failed.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    std::size_t helpers = std::min(concurrency, tasks);
+    helpers = helpers ? helpers - 1 : 0;
+    st.running = helpers;
+    for (std::size_t k = 0; k < helpers; ++k) {
+        try {
+            executor([&st, &work] {
+                work();
+                // 解锁是工作者对 st 的最后一次访问 / Unlocking is the worker's last touch of st
+                std::lock_guard<std::mutex> lock(st.mutex);
+                if (--st.running == 0) st.done.notify_all();
+            });
+        } catch (...) {
+            // 提交失败时少用几个工作者，调用线程照样能做完全部任务 / Fewer workers if submission fails; the caller can still finish every task
+            std::lock_guard<std::mutex> lock(st.mutex);
+            st.running -= helpers - k;
+            break;
+        }
+    }
+
+    work();
+    {
+        std::unique_lock<std::mutex> lock(st.mutex);
+        st.done.wait(lock, [&st] { return st.running == 0; });
+    }
+    if (st.error) std::rethrow_exception(st.error);
+}
+
+} // namespace pooled_detail
@@ -0,0 +1,313 @@
+//
+//  PooledSerialize.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  容器二进制流格式 / Container binary stream format
+//  -----------------------------------------------------------------------------
+//
+//  PooledMap / PooledList 的 serialize(writer) 与 deserialize(reader) 共用的编码层。
+//
+//  流 = 文件头 + 若干数据块 + 结束块：
+//    文件头：magic[4]（"PMAP" / "PLST"）、字节序标记、键与值的定长字节数（变长为 0）、元素数；
+//    数据块：u32 字节数 + u32 元素数 + 按序排列的元素，元素不跨块；
+//    结束块：字节数与元素数均为 0。
+//  写端把元素攒进一个块缓冲区，满约 64 KiB 后一次交给 writer，块头就地回填，
+//  每块只调用一次 write()；可平凡复制的类型逐个 memcpy 进缓冲区。
+//  读端每次只读取一个块的确切字节数，不会越过流尾多读，流后面可以紧跟其他数据。
+//  数值按本机字节序写入，字节序不同的流在读取时被拒绝。
+//
+//  Writer 需提供 `void write(const void* data, std::size_t bytes)`；
+//  Reader 需提供 `std::size_t read(void* data, std::size_t bytes)`，返回实际读到的字节数，
+//  少于请求时视为流提前结束。其他类型通过特化 PooledCodec<T> 支持。
+//
+//  The encoding layer shared by serialize(writer) and deserialize(reader)
+//  on PooledMap / PooledList.
+//
+//  A stream is a header, data chunks and an end chunk:
+//    header: magic[4] ("PMAP" / "PLST"), a byte-order mark, the fixed key
+//            and value sizes (0 when variable), and the element count;
+//    chunk:  u32 byte count + u32 element count + the elements in order,
+//            never splitting an element across chunks;
+//    end:    a chunk with zero bytes and zero elements.
+//  The writer gathers elements in a chunk buffer and hands roughly 64 KiB at
+//  a time to the writer, back-filling the chunk header in place so each chunk
+//  is a single write() call; trivially copyable types are memcpy'd into the
+//  buffer. The reader asks for exactly one chunk's bytes at a time and never
+//  reads past the end of the stream, so other data may follow it. Values are
+//  written in native byte order, and a stream with a different byte order is
+//  rejected on read.
+//
+//  A Writer provides `void write(const void* data, std::size_t bytes)`; a
+//  Reader provides `std::size_t read(void* data, std::size_t bytes)`
+//  returning the bytes actually read, where a short read means the stream
+//  ended early. Other types are supported by specializing PooledCodec<T>.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief 元素编解码器，可为自定义类型特化 / Element codec, specializable for user types
+ *
+ * 特化需提供 / A specialization provides:
+ * - `static constexpr std::size_t fixed_size`：定长字节数，变长为 0 / fixed byte size, 0 when variable
+ * - `template <class Out> static void write(Out& out, const T& v)`：以 `out.put(data, bytes)` 输出 / emit through `out.put(data, bytes)`
+ * - `template <class In> static T read(In& in)`：以 `in.get(data, bytes)` 读取 / read through `in.get(data, bytes)`
+ *
+ * 默认支持可平凡复制的类型（逐字节复制）与 std::basic_string（u64 长度 + 字符）。
+ * 读入 bool 时只接受 0 / 1；枚举与含 bool 或枚举成员的结构体按原样复制，不校验取值，
+ * 流不可信时应为它们特化 PooledCodec。
+ * Trivially copyable types (copied byte for byte) and std::basic_string
+ * (u64 length + characters) are supported out of the box. A bool only
+ * reads back from 0 / 1; enums and structs with bool or enum members are
+ * copied as is without checking their values, so specialize PooledCodec for
+ * them when the stream is untrusted.
+ */
+template <typename T, typename = void>
+struct PooledCodec {
+    static_assert(sizeof(T) == 0, "no PooledCodec for this type; specialize PooledCodec<T>");
+};
+
+template <typename T>
+struct PooledCodec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static constexpr std::size_t fixed_size = sizeof(T);
+
+    template <typename Out>
+    static void write(Out& out, const T& v) { out.put(&v, sizeof(T)); }
+
+    // 字节读入对齐的存储后复制出来，不要求 T 可默认构造 / Bytes land in aligned storage and are copied out, so T need not be default constructible
+    template <typename In>
+    static T read(In& in) {
+        alignas(T) unsigned char raw[sizeof(T)];
+        in.get(raw, sizeof(T));
+        // 其他字节值作为 bool 读出是未定义行为 / Reading any other byte as a bool is undefined behaviour
+        if constexpr (std::is_same_v<std::remove_cv_t<T>, bool>) {
+            if (raw[0] > 1) throw std::runtime_error("PooledCodec: invalid bool value");
+        }
+        return *std::launder(reinterpret_cast<T*>(raw));
+    }
+};
+
+template <typename CharT, typename Traits, typename Alloc>
+struct PooledCodec<std::basic_string<CharT, Traits, Alloc>> {
+    using String = std::basic_string<CharT, Traits, Alloc>;
+    static constexpr std::size_t fixed_size = 0;
+
+    template <typename Out>
+    static void write(Out& out, const String& s) {
+        std::uint64_t n = s.size();
+        out.put(&n, sizeof(n));
+        out.put(s.data(), s.size() * sizeof(CharT));
+    }
+
+    template <typename In>
+    static String read(In& in) {
+        std::uint64_t n = 0;
+        in.get(&n, sizeof(n));
+        // 长度不可信，先确认块内确有这么多字节 / The length is untrusted; make sure the chunk holds that many bytes first
+        if (n > in.remaining() / sizeof(CharT)) throw std::runtime_error("PooledCodec: string length exceeds its chunk");
+        String s(static_cast<std::size_t>(n), CharT());
+        in.get(s.data(), s.size() * sizeof(CharT));
+        return s;
+    }
+};
+
+namespace pooled_detail {
+
+// 流种类，写在文件头的 magic 里 / Stream kind, written as the header magic
+enum class StreamKind : std::uint32_t {
+    Map  = 0x50414D50u,   // "PMAP"
+    List = 0x54534C50u,   // "PLST"
+};
+
+inline constexpr std::uint32_t stream_byte_order = 0x01020304u;
+
+/// 写出时的块大小，也是读入时缓冲区的增长步长 / Chunk size on write, and the buffer growth step on read
+inline constexpr std::size_t stream_chunk_bytes = std::size_t(64) << 10;
+
+struct StreamHeader {
+    std::uint32_t magic;
+    std::uint32_t byte_order;
+    std::uint32_t key_size;     ///< 键的定长字节数，变长为 0 / fixed key size, 0 when variable
+    std::uint32_t value_size;   ///< 值的定长字节数，变长或无值为 0 / fixed value size, 0 when variable or absent
+    std::uint64_t count;
+};
+
+struct ChunkHeader {
+    std::uint32_t bytes;
+    std::uint32_t elements;
+};
+
+/**
+ * @brief 分块写出 / Chunked writer
+ *
+ * 缓冲区开头预留块头，满块时回填块头并整块写出。
+ * The buffer starts with room for the chunk header, which is back-filled
+ * when the chunk is written out whole.
+ */
+template <typename Writer>
+class ChunkWriter {
+public:
+    static constexpr std::size_t chunk_bytes = stream_chunk_bytes;
+
+    explicit ChunkWriter(Writer& writer) : writer_(writer) {
+        buffer_.reserve(chunk_bytes + sizeof(ChunkHeader));
+        buffer_.resize(sizeof(ChunkHeader));
+    }
+
+    void header(StreamKind kind, std::size_t key_size, std::size_t value_size, std::size_t count) {
+        StreamHeader h{ static_cast<std::uint32_t>(kind), stream_byte_order,
+                        static_cast<std::uint32_t>(key_size), static_cast<std::uint32_t>(value_size), count };
+        writer_.write(&h, sizeof(h));
+    }
+
+    void put(const void* data, std::size_t bytes) {
+        std::size_t at = buffer_.size();
+        buffer_.resize(at + bytes);
+        std::memcpy(buffer_.data() + at, data, bytes);
+    }
+
+    // 每写完一个元素调用一次，满块即写出 / Call after each element; writes the chunk out once full
+    void end_element() {
+        ++elements_;
+        if (buffer_.size() >= chunk_bytes) emit();
+    }
+
+    // 写出剩余元素与结束块 / Write the remaining elements and the end chunk
+    void finish() {
+        if (elements_) emit();
+        emit();
+    }
+
+private:
+    void emit() {
+        std::size_t bytes = buffer_.size() - sizeof(ChunkHeader);
+        if (bytes > std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("PooledSerialize: element too large for a chunk");
+        ChunkHeader ch{ static_cast<std::uint32_t>(bytes), elements_ };
+        std::memcpy(buffer_.data(), &ch, sizeof(ch));
+        writer_.write(buffer_.data(), buffer_.size());
+        buffer_.resize(sizeof(ChunkHeader));
+        elements_ = 0;
+    }
+
+    Writer& writer_;
+    std::vector<unsigned char> buffer_;
+    std::uint32_t elements_ = 0;
+};
+
+/**
+ * @brief 分块读入 / Chunked reader
+ *
+ * 一次读入一整块，元素只在块内解码；流中的长度与计数均视为不可信，逐项校验。
+ * 缓冲区按 stream_chunk_bytes 逐步增长，内存只随流中实际存在的字节增加；
+ * 定长元素的块还须满足 字节数 == 元素数 × 元素大小。
+ * Reads one whole chunk at a time and decodes elements only within it;
+ * lengths and counts in the stream are untrusted and checked throughout.
+ * The buffer grows in stream_chunk_bytes steps, so memory follows the bytes
+ * actually present in the stream; chunks of fixed-size elements must also
+ * satisfy bytes == elements × element size.
+ */
+template <typename Reader>
+class ChunkReader {
+public:
+    explicit ChunkReader(Reader& reader) : reader_(reader) {}
+
+    // 读取并校验文件头，返回元素数 / Read and check the header, returning the element count
+    std::uint64_t header(StreamKind kind, std::size_t key_size, std::size_t value_size) {
+        StreamHeader h;
+        read_exact(&h, sizeof(h));
+        if (h.magic != static_cast<std::uint32_t>(kind)) throw std::runtime_error("PooledSerialize: wrong stream kind");
+        if (h.byte_order != stream_byte_order) throw std::runtime_error("PooledSerialize: stream byte order differs");
+        if (h.key_size != key_size || h.value_size != value_size)
+            throw std::runtime_error("PooledSerialize: stream element types differ");
+        // 映射的值大小为 0 表示变长，链表则表示没有值 / A zero value size means variable for maps and absent for lists
+        bool fixed = key_size && (kind == StreamKind::List || value_size);
+        element_bytes_ = fixed ? key_size + value_size : 0;
+        return h.count;
+    }
+
+    // 定位到下一个元素，读到结束块时返回 false / Move to the next element; false at the end chunk
+    bool next() {
+        while (elements_ == 0) {
+            if (pos_ != buffer_.size()) throw std::runtime_error("PooledSerialize: trailing bytes in chunk");
+            ChunkHeader ch;
+            read_exact(&ch, sizeof(ch));
+            if (ch.elements == 0) {
+                if (ch.bytes != 0) throw std::runtime_error("PooledSerialize: malformed end chunk");
+                return false;
+            }
+            if (ch.elements > ch.bytes || (element_bytes_ && ch.bytes != std::uint64_t(ch.elements) * element_bytes_))
+                throw std::runtime_error("PooledSerialize: malformed chunk");
+            // 分步读入，截断或伪造的块头不会先行分配整块 / Read in steps, so a truncated or forged header cannot allocate the whole chunk up front
+            buffer_.clear();
+            for (std::size_t have = 0; have < ch.bytes;) {
+                std::size_t step = std::min<std::size_t>(ch.bytes - have, stream_chunk_bytes);
+                buffer_.resize(have + step);
+                read_exact(buffer_.data() + have, step);
+                have += step;
+            }
+            pos_ = 0;
+            elements_ = chunk_size_ = ch.elements;
+        }
+        --elements_;
+        return true;
+    }
+
+    // 当前元素是否为本块第一个，及本块元素数 / Whether the current element opens its chunk, and the chunk's element count
+    bool starts_chunk() const noexcept { return elements_ + 1 == chunk_size_; }
+    std::size_t chunk_size() const noexcept { return chunk_size_; }
+
+    std::size_t remaining() const noexcept { return buffer_.size() - pos_; }
+
+    void get(void* data, std::size_t bytes) {
+        if (bytes > remaining()) throw std::runtime_error("PooledSerialize: element overruns its chunk");
+        std::memcpy(data, buffer_.data() + pos_, bytes);
+        pos_ += bytes;
+    }
+
+private:
+    void read_exact(void* data, std::size_t bytes) {
+        if (reader_.read(data, bytes) != bytes) throw std::runtime_error("PooledSerialize: unexpected end of stream");
+    }
+
+    Reader& reader_;
+    std::vector<unsigned char> buffer_;
+    std::size_t pos_ = 0;
+    std::size_t element_bytes_ = 0;  ///< 定长元素的字节数，变长为 0 / bytes per fixed-size element, 0 when variable
+    std::uint32_t elements_ = 0;     ///< 本块尚未读取的元素 / elements of the chunk not yet read
+    std::uint32_t chunk_size_ = 0;
+};
+
+} // namespace pooled_detail
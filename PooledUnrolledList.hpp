@@ -0,0 +1,556 @@
+/*
+ * PooledUnrolledList.hpp
+ *
+ * 版权所有 (c) 2025 大熊哥哥 (Bighiung)
+ * All rights reserved / 保留所有权利
+ *
+ * 使用许可 / License Terms:
+ *
+ * 本代码允许在个人、学术及商业项目中自由使用、修改和分发，
+ * 但必须在所有副本及衍生作品中保留本声明，且明确标注作者为：
+ *
+ *      大熊哥哥 (Bighiung)
+ *
+ * 禁止去除或修改此版权声明。
+ *
+ * This code is free to use, modify, and distribute in personal,
+ * academic, and commercial projects, provided that this notice
+ * is retained in all copies or derivative works, and the author
+ * is explicitly acknowledged as:
+ *
+ *      大熊哥哥 (Bighiung)
+ *
+ * Removal or alteration of this copyright notice is prohibited.
+ *
+ * ---------------------------------------------------------------
+ *
+ * PooledUnrolledList - 池化展开链表模板类
+ *
+ * 功能 / Features:
+ * 1. 每个池化节点（块）连续存放至多 ChunkSize 个元素，顺序扫描接近 std::vector /
+ *    Every pooled node (chunk) stores up to ChunkSize elements contiguously, so scans run close to std::vector speed.
+ * 2. 接口与 PooledList 一致：push_back、push_front、insert、erase、insert_list、operator[] 等 /
+ *    Same interface as PooledList: push_back, push_front, insert, erase, insert_list, operator[] ...
+ * 3. 块满时对半分裂，相邻块过空时合并，块内插入删除只移动本块元素 /
+ *    Full chunks split in half and sparse neighbours merge; insert/erase only shift elements of one chunk.
+ * 4. 以块元素数为权重的隐式 Treap 索引，定位与插入删除 O(log n + ChunkSize) /
+ *    An implicit treap weighted by chunk fill gives O(log n + ChunkSize) positional access, insert and erase.
+ * 5. insert_list 至多切分一个块后整链拼接，O(log n + ChunkSize) /
+ *    insert_list splits at most one chunk and then splices the whole chain, O(log n + ChunkSize).
+ * 6. for_each_chunk 按块交出连续区间，便于编译器向量化 /
+ *    for_each_chunk hands out contiguous runs the compiler can vectorize.
+ *
+ * 与 PooledList 的差异 / Differences from PooledList:
+ * - 元素在块内紧凑存放，插入删除会移动同块元素，可能使迭代器与引用失效；块本身始终是池化内存。
+ *   Elements are packed inside chunks and insert/erase shift their chunk
+ *   neighbours, which may invalidate iterators and references; the chunks
+ *   themselves always stay in pooled memory.
+ * - T 须可无异常移动构造 / T must be nothrow move constructible.
+ */
+
+#pragma once
+#include "PoolPolicy.hpp"
+#include "ImplicitTreap.hpp"
+#include "RawSlots.hpp"
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace pooled_detail {
+
+// 默认块大小：元素部分约 256 字节，介于 4 与 64 之间 / Default chunk size: about 256 bytes of elements, between 4 and 64
+constexpr std::size_t unrolled_chunk_size(std::size_t elem_bytes) noexcept {
+    return 256 / elem_bytes < 4 ? 4 : (256 / elem_bytes > 64 ? 64 : 256 / elem_bytes);
+}
+
+// 块的权重为其元素个数 / A chunk weighs as many positions as it holds elements
+struct ChunkWeight {
+    template <typename Chunk>
+    static std::size_t of(const Chunk* c) noexcept { return c->_used; }
+};
+
+} // namespace pooled_detail
+
+// ChunkSize: 每块元素数 / elements per chunk; Pool: 节点池策略，见 PoolPolicy.hpp / node pool policy, see PoolPolicy.hpp
+template <typename T, std::size_t ChunkSize = pooled_detail::unrolled_chunk_size(sizeof(T)),
+          typename Pool = SegmentedPoolPolicy>
+class PooledUnrolledList {
+    static_assert(ChunkSize >= 2, "PooledUnrolledList needs at least two elements per chunk");
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "PooledUnrolledList relocates elements inside chunks and needs nothrow move construction");
+
+private:
+    // 元素不由块的析构函数管理，回收前显式析构，池支持整体释放且 T 平凡析构时可 O(1) 丢弃
+    // Elements are not owned by the chunk's destructor but destroyed explicitly
+    // before recycling, so with a bulk-release pool and trivial T a drop is O(1).
+    struct Chunk : public Pool::template node_base<Chunk> {
+        pooled_detail::RawSlots<T, ChunkSize> _slots;
+        std::size_t _used = 0;
+        Chunk* _prev = nullptr;
+        Chunk* _next = nullptr;
+        // 位置索引 / Positional index links
+        Chunk* _left = nullptr;
+        Chunk* _right = nullptr;
+        Chunk* _parent = nullptr;
+        std::size_t _count = 0;
+        std::uint32_t _priority = 0;
+
+        T* data() noexcept { return _slots.data(); }
+        const T* data() const noexcept { return _slots.data(); }
+    };
+
+    // 相邻两块合计不超过此值时合并 / Adjacent chunks merge when together they hold at most this many
+    static constexpr std::size_t merge_limit = ChunkSize - ChunkSize / 4;
+
+    Chunk* _head = nullptr;
+    Chunk* _tail = nullptr;
+    std::size_t _size = 0;
+    ImplicitTreap<Chunk, pooled_detail::ChunkWeight> _index; // 位置索引 / positional index
+    Pool _pool;                                               // 节点池策略 / node pool policy
+
+public:
+    static constexpr std::size_t chunk_size = ChunkSize;
+
+    // -------- 迭代器 / Iterators --------
+    // (块, 块内下标) 双向迭代器，end() 自减得到尾元素 / (chunk, offset) bidirectional iterator; decrementing end() yields the tail
+    template <bool Const>
+    class basic_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type        = T;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = std::conditional_t<Const, const T&, T&>;
+        using pointer           = std::conditional_t<Const, const T*, T*>;
+
+        basic_iterator() = default;
+
+        // 非 const 迭代器可隐式转换为 const 迭代器 / iterator converts to const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        basic_iterator(const basic_iterator<false>& other) noexcept
+            : _chunk(other._chunk), _off(other._off), _list(other._list) {}
+
+        reference operator*() const noexcept { return _chunk->data()[_off]; }
+        pointer operator->() const noexcept { return _chunk->data() + _off; }
+
+        basic_iterator& operator++() noexcept {
+            if (++_off == _chunk->_used) {
+                _chunk = _chunk->_next;
+                _off = 0;
+            }
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        basic_iterator& operator--() noexcept {
+            if (!_chunk) {
+                _chunk = _list->_tail;
+                _off = _chunk->_used - 1;
+            } else if (_off == 0) {
+                _chunk = _chunk->_prev;
+                _off = _chunk->_used - 1;
+            } else {
+                --_off;
+            }
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        template <bool C>
+        bool operator==(const basic_iterator<C>& other) const noexcept {
+            return _chunk == other._chunk && _off == other._off;
+        }
+        template <bool C>
+        bool operator!=(const basic_iterator<C>& other) const noexcept { return !(*this == other); }
+
+    private:
+        friend class PooledUnrolledList;
+        friend class basic_iterator<!Const>;
+
+        basic_iterator(Chunk* chunk, std::size_t off, const PooledUnrolledList* list) noexcept
+            : _chunk(chunk), _off(off), _list(list) {}
+
+        Chunk* _chunk = nullptr;
+        std::size_t _off = 0;
+        const PooledUnrolledList* _list = nullptr;
+    };
+
+    using iterator               = basic_iterator<false>;
+    using const_iterator         = basic_iterator<true>;
+    using reverse_iterator       = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    PooledUnrolledList() = default;
+    // 使用指定的池实例构造，例如 NodeArena / Construct with a specific pool instance, e.g. a NodeArena
+    explicit PooledUnrolledList(const Pool& pool) : _pool(pool) {}
+    ~PooledUnrolledList() { clear(); }
+
+    // 块归链表独占，禁止隐式拷贝；需要副本时调用 clone() / Chunks are owned exclusively: no implicit copy, use clone()
+    PooledUnrolledList(const PooledUnrolledList&) = delete;
+    PooledUnrolledList& operator=(const PooledUnrolledList&) = delete;
+
+    // 移动构造，O(1)，other 变为空 / Move construction, O(1); other is left empty
+    PooledUnrolledList(PooledUnrolledList&& other) noexcept : _pool(other._pool) { swap(other); }
+
+    // 移动赋值：先归还自身块再接管 / Move assignment: return own chunks, then take over
+    PooledUnrolledList& operator=(PooledUnrolledList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    // 交换两个链表的全部内容，O(1)，不分配 / Swap the entire contents of two lists, O(1), no allocation
+    void swap(PooledUnrolledList& other) noexcept {
+        using std::swap;
+        swap(_head, other._head);
+        swap(_tail, other._tail);
+        swap(_size, other._size);
+        _index.swap(other._index);
+        swap(_pool, other._pool);
+    }
+
+    friend void swap(PooledUnrolledList& a, PooledUnrolledList& b) noexcept { a.swap(b); }
+
+    // 显式深拷贝，O(n)，可指定副本的池实例 / Explicit deep copy in O(n), optionally into another pool instance
+    PooledUnrolledList clone() const { return clone(_pool); }
+
+    PooledUnrolledList clone(const Pool& pool) const {
+        PooledUnrolledList copy(pool);
+        for_each([&copy](const T& v) { copy.push_back(v); });
+        return copy;
+    }
+
+    iterator begin() noexcept { return iterator(_head, 0, this); }
+    const_iterator begin() const noexcept { return const_iterator(_head, 0, this); }
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    iterator end() noexcept { return iterator(nullptr, 0, this); }
+    const_iterator end() const noexcept { return const_iterator(nullptr, 0, this); }
+    const_iterator cend() const noexcept { return end(); }
+
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+    const_reverse_iterator crend() const noexcept { return rend(); }
+
+    bool empty() const noexcept { return _size == 0; }
+    std::size_t size() const noexcept { return _size; }
+
+#ifdef POOLED_CONTAINER_STATS
+    // 块的池统计（每块至多 ChunkSize 个元素），见 PoolStats.hpp / Pool statistics of the chunks (up to ChunkSize elements each), see PoolStats.hpp
+    PoolStats pool_stats() const { return _pool.template stats<Chunk>(); }
+#endif
+
+    T& front() { if (!_head) throw std::out_of_range("PooledUnrolledList is empty"); return _head->data()[0]; }
+    T& back()  { if (!_tail) throw std::out_of_range("PooledUnrolledList is empty"); return _tail->data()[_tail->_used - 1]; }
+
+    // -------- 插入 --------
+    template <typename... Args>
+    void push_back(Args&&... args) {
+        if (_tail && _tail->_used < ChunkSize) {
+            ::new (static_cast<void*>(_tail->data() + _tail->_used)) T(std::forward<Args>(args)...);
+            ++_tail->_used;
+            _index.adjust(_tail, 1);
+            ++_size;
+            return;
+        }
+        Chunk* c = make_chunk(std::forward<Args>(args)...);
+        link_chunk(c, _tail, nullptr);
+        ++_size;
+    }
+
+    template <typename... Args>
+    void push_front(Args&&... args) {
+        if (_head && _head->_used < ChunkSize) {
+            emplace_in_chunk(_head, 0, std::forward<Args>(args)...);
+            return;
+        }
+        Chunk* c = make_chunk(std::forward<Args>(args)...);
+        link_chunk(c, nullptr, _head);
+        ++_size;
+    }
+
+    // -------- 插入指定值 --------
+    void insert(std::size_t pos, const T& value) { emplace(pos, value); }
+    void insert(std::size_t pos, T&& value) { emplace(pos, std::move(value)); }
+
+    // 在 pos 处原位构造；所在块已满时先对半分裂 / Construct in place at pos; a full chunk is split in half first
+    template <typename... Args>
+    void emplace(std::size_t pos, Args&&... args) {
+        if (pos > _size) throw std::out_of_range("PooledUnrolledList insert position out of range");
+        if (pos == _size) {
+            push_back(std::forward<Args>(args)...);
+            return;
+        }
+        std::size_t off = pos;
+        Chunk* c = _index.locate(off);
+        if (c->_used == ChunkSize) {
+            std::size_t half = ChunkSize / 2;
+            Chunk* upper = split_chunk(c, half);
+            if (off > half) {
+                c = upper;
+                off -= half;
+            }
+        }
+        emplace_in_chunk(c, off, std::forward<Args>(args)...);
+    }
+
+    // -------- 插入另一个 PooledUnrolledList (move) --------
+    // 至多切分 pos 所在的一个块，然后整链拼接 / Splits at most the chunk holding pos, then splices the whole chain
+    void insert_list(std::size_t pos, PooledUnrolledList&& other) {
+        if (pos > _size) throw std::out_of_range("PooledUnrolledList insert position out of range");
+        if (other.empty()) return;
+        if (!(_pool == other._pool)) throw std::invalid_argument("PooledUnrolledList insert_list requires interchangeable pools");
+
+        Chunk* next = nullptr;
+        if (pos < _size) {
+            std::size_t off = pos;
+            next = _index.locate(off);
+            if (off > 0) next = split_chunk(next, off);
+        }
+        Chunk* prev = next ? next->_prev : _tail;
+
+        other._head->_prev = prev;
+        if (prev) prev->_next = other._head; else _head = other._head;
+        other._tail->_next = next;
+        if (next) next->_prev = other._tail; else _tail = other._tail;
+
+        // 整棵索引树按位置拼接，O(log n) / Paste the whole index tree at pos, O(log n)
+        _index.paste(pos, other._index.release());
+
+        _size += other._size;
+        other._head = other._tail = nullptr;
+        other._size = 0;
+    }
+
+    // -------- 删除 --------
+    void erase(std::size_t idx) {
+        if (idx >= _size) throw std::out_of_range("PooledUnrolledList index out of range");
+        std::size_t off = idx;
+        Chunk* c = _index.locate(off);
+        erase_in_chunk(c, off);
+    }
+
+    void pop_front() { if (_head) erase_in_chunk(_head, 0); }
+    void pop_back()  { if (_tail) erase_in_chunk(_tail, _tail->_used - 1); }
+
+    void clear() {
+        Chunk* cur = _head;
+        while (cur) {
+            Chunk* next = cur->_next;
+            destroy_elements(cur);
+            _pool.recycle(cur);
+            cur = next;
+        }
+        _head = _tail = nullptr;
+        _size = 0;
+        _index.reset();
+    }
+
+    // 整体丢弃所有块：池支持整体释放时只析构元素（均平凡析构时 O(1)），否则等同 clear()
+    // Drop every chunk at once: with a bulk-release pool only destructors run
+    // (O(1) when all are trivial), otherwise the same as clear()
+    void release_all() {
+        if constexpr (pooled_detail::supports_bulk_release<Pool>::value) {
+            if constexpr (!std::is_trivially_destructible_v<T> || !std::is_trivially_destructible_v<Chunk>) {
+                for (Chunk* cur = _head; cur;) {
+                    Chunk* next = cur->_next;
+                    destroy_elements(cur);
+                    _pool.discard(cur);
+                    cur = next;
+                }
+            }
+            _head = _tail = nullptr;
+            _size = 0;
+            _index.reset();
+        } else {
+            clear();
+        }
+    }
+
+    // -------- 遍历 / Traversal --------
+    template <typename Func>
+    void for_each(Func&& fn) {
+        for (Chunk* c = _head; c; c = c->_next) {
+            T* d = c->data();
+            for (std::size_t i = 0, n = c->_used; i < n; ++i) fn(d[i]);
+        }
+    }
+
+    template <typename Func>
+    void for_each(Func&& fn) const {
+        for (const Chunk* c = _head; c; c = c->_next) {
+            const T* d = c->data();
+            for (std::size_t i = 0, n = c->_used; i < n; ++i) fn(d[i]);
+        }
+    }
+
+    template <typename Func>
+    void for_each_const(Func&& fn) const { for_each(std::forward<Func>(fn)); }
+
+    // fn 返回 false 时提前停止；完整遍历返回 true / Stops as soon as fn returns false; returns true if every element was visited
+    template <typename Func>
+    bool for_each_while(Func&& fn) {
+        for (Chunk* c = _head; c; c = c->_next) {
+            T* d = c->data();
+            for (std::size_t i = 0, n = c->_used; i < n; ++i) {
+                if (!fn(d[i])) return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Func>
+    bool for_each_while(Func&& fn) const {
+        for (const Chunk* c = _head; c; c = c->_next) {
+            const T* d = c->data();
+            for (std::size_t i = 0, n = c->_used; i < n; ++i) {
+                if (!fn(d[i])) return false;
+            }
+        }
+        return true;
+    }
+
+    // 按块遍历：fn(T* data, std::size_t n)，每次交出一段连续元素 / Per-chunk traversal: fn(T* data, std::size_t n) over each contiguous run
+    template <typename Func>
+    void for_each_chunk(Func&& fn) {
+        for (Chunk* c = _head; c; c = c->_next) fn(c->data(), c->_used);
+    }
+
+    template <typename Func>
+    void for_each_chunk(Func&& fn) const {
+        for (const Chunk* c = _head; c; c = c->_next) fn(c->data(), c->_used);
+    }
+
+    T& operator[](std::size_t idx) {
+        if (idx >= _size) throw std::out_of_range("PooledUnrolledList index out of range");
+        Chunk* c = _index.locate(idx);
+        return c->data()[idx];
+    }
+
+    const T& operator[](std::size_t idx) const {
+        if (idx >= _size) throw std::out_of_range("PooledUnrolledList index out of range");
+        const Chunk* c = _index.locate(idx);
+        return c->data()[idx];
+    }
+
+    // 交换两个位置上的值 / Swap the values at two positions
+    void swap_nodes(std::size_t idx1, std::size_t idx2) {
+        if (idx1 >= _size || idx2 >= _size) throw std::out_of_range("PooledUnrolledList index out of range");
+        if (idx1 == idx2) return;
+        using std::swap;
+        swap((*this)[idx1], (*this)[idx2]);
+    }
+
+private:
+    // 新建只含一个元素、尚未挂接的块 / Build an unlinked chunk holding one element
+    template <typename... Args>
+    Chunk* make_chunk(Args&&... args) {
+        Chunk* c = _pool.template create<Chunk>();
+        try {
+            ::new (static_cast<void*>(c->data())) T(std::forward<Args>(args)...);
+        } catch (...) {
+            _pool.recycle(c);
+            throw;
+        }
+        c->_used = 1;
+        return c;
+    }
+
+    // 把块挂在链表中 prev 与 next 之间并加入索引 / Link a chunk between prev and next in the list and the index
+    void link_chunk(Chunk* c, Chunk* prev, Chunk* next) noexcept {
+        c->_prev = prev;
+        c->_next = next;
+        if (prev) prev->_next = c; else _head = c;
+        if (next) next->_prev = c; else _tail = c;
+        _index.link(c, prev, next);
+    }
+
+    void unlink_chunk(Chunk* c) noexcept {
+        if (c->_prev) c->_prev->_next = c->_next; else _head = c->_next;
+        if (c->_next) c->_next->_prev = c->_prev; else _tail = c->_prev;
+        _index.unlink(c);
+    }
+
+    static void destroy_elements(Chunk* c) noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            T* d = c->data();
+            for (std::size_t i = 0; i < c->_used; ++i) d[i].~T();
+        }
+    }
+
+    // 把 [at, used) 移入紧随其后的新块，返回新块 / Move [at, used) into a new chunk right after c and return it
+    Chunk* split_chunk(Chunk* c, std::size_t at) {
+        Chunk* upper = _pool.template create<Chunk>();
+        std::size_t moved = c->_used - at;
+        pooled_detail::relocate(upper->data(), c->data() + at, moved);
+        upper->_used = moved;
+        c->_used = at;
+        _index.adjust(c, -static_cast<std::ptrdiff_t>(moved));
+        link_chunk(upper, c, c->_next);
+        return upper;
+    }
+
+    // 块内有空位时在 off 处构造 / Construct at off inside a chunk that has room
+    template <typename... Args>
+    void emplace_in_chunk(Chunk* c, std::size_t off, Args&&... args) {
+        T* d = c->data();
+        std::size_t tail = c->_used - off;
+        pooled_detail::relocate(d + off + 1, d + off, tail);
+        try {
+            ::new (static_cast<void*>(d + off)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pooled_detail::relocate(d + off, d + off + 1, tail);
+            throw;
+        }
+        ++c->_used;
+        _index.adjust(c, 1);
+        ++_size;
+    }
+
+    void erase_in_chunk(Chunk* c, std::size_t off) {
+        T* d = c->data();
+        d[off].~T();
+        pooled_detail::relocate(d + off, d + off + 1, c->_used - off - 1);
+        --c->_used;
+        _index.adjust(c, -1);
+        --_size;
+
+        if (c->_used == 0) {
+            unlink_chunk(c);
+            _pool.recycle(c);
+        } else if (!merge_next(c) && c->_prev) {
+            merge_next(c->_prev);
+        }
+    }
+
+    // 后继块能整体并入 c 时合并 / Fold the next chunk into c when both fit
+    bool merge_next(Chunk* c) noexcept {
+        Chunk* next = c->_next;
+        if (!next || c->_used + next->_used > merge_limit) return false;
+        unlink_chunk(next);
+        pooled_detail::relocate(c->data() + c->_used, next->data(), next->_used);
+        _index.adjust(c, static_cast<std::ptrdiff_t>(next->_used));
+        c->_used += next->_used;
+        next->_used = 0;
+        _pool.recycle(next);
+        return true;
+    }
+};
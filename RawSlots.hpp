@@ -0,0 +1,78 @@
+//
+//  RawSlots.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  定长元素槽 / Fixed element slots
+//  -----------------------------------------------------------------------------
+//
+//  PooledBTreeMap 的叶子与 PooledUnrolledList 的块在一个池化节点内存放多个元素：
+//  槽位不预先构造，元素按需原位构造，插入删除时整体重定位。
+//
+//  PooledBTreeMap leaves and PooledUnrolledList chunks keep several elements
+//  in one pooled node: slots start unconstructed, elements are built in place
+//  on demand and relocated as a block on insert and erase.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pooled_detail {
+
+/// 未初始化的定长元素槽 / Fixed-size array of uninitialized element slots
+template <typename T, std::size_t N>
+struct RawSlots {
+    alignas(T) unsigned char bytes[sizeof(T) * N];
+
+    T* data() noexcept { return std::launder(reinterpret_cast<T*>(bytes)); }
+    const T* data() const noexcept { return std::launder(reinterpret_cast<const T*>(bytes)); }
+    T& operator[](std::size_t i) noexcept { return data()[i]; }
+    const T& operator[](std::size_t i) const noexcept { return data()[i]; }
+};
+
+// 将 [src, src + n) 重定位到 dst（允许重叠），源对象随之析构
+// Relocate n objects from src to dst (ranges may overlap); the sources are destroyed
+template <typename T>
+void relocate(T* dst, T* src, std::size_t n) noexcept {
+    if (n == 0 || dst == src) return;
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(T));
+    } else if (dst < src) {
+        for (std::size_t i = 0; i < n; ++i) {
+            ::new (static_cast<void*>(dst + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    } else {
+        for (std::size_t i = n; i-- > 0;) {
+            ::new (static_cast<void*>(dst + i)) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
+}
+
+} // namespace pooled_detail
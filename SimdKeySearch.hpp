@@ -0,0 +1,244 @@
+//
+//  SimdKeySearch.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  使用本代码时，必须在显著位置保留作者姓名 "大熊哥哥 (Bighiung)"。
+//  本代码可自由复制、修改、发布、分发或用于商业用途，但请保留完整版权声明。
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//  THE SOFTWARE.
+//
+//  -----------------------------------------------------------------------------
+//  节点内 SIMD 键查找 / SIMD in-node key search
+//  -----------------------------------------------------------------------------
+//
+//  对有序整数键数组统计 `keys[i] < key`（或 `keys[i] > key`）的个数，即节点内的下标。
+//  支持 int32 / uint32 / int64 / uint64，按编译目标在编译期选择内核：
+//  1. AVX-512F：一次比较 16 / 8 个键，直接得到掩码，尾部使用掩码加载。
+//  2. AVX2：一次比较 8 / 4 个键，movemask 后 popcount。
+//  3. NEON (AArch64)：比较结果为全 1 通道，逐向量累加后横向求和。
+//  4. 其他类型或目标：无分支的标量计数。
+//  无符号键通过翻转最高位转换为有符号比较（AVX-512 直接使用无符号比较）。
+//  定义 POOLED_CONTAINER_NO_SIMD 可强制使用标量路径。
+//
+//  Counts `keys[i] < key` (or `keys[i] > key`) over a sorted integer key
+//  array, which is exactly the slot index inside a node. int32 / uint32 /
+//  int64 / uint64 are supported and the kernel is picked at compile time from
+//  the target:
+//  1. AVX-512F: 16 / 8 keys per compare straight into a mask; the tail uses a
+//     masked load.
+//  2. AVX2: 8 / 4 keys per compare, movemask then popcount.
+//  3. NEON (AArch64): compares yield all-ones lanes that are accumulated per
+//     vector and summed horizontally at the end.
+//  4. Any other type or target: a branch-free scalar count.
+//  Unsigned keys are compared as signed after flipping the top bit
+//  (AVX-512 compares unsigned natively).
+//  Define POOLED_CONTAINER_NO_SIMD to force the scalar path.
+//
+//  Author: 大熊哥哥 (Bighiung)
+//
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined(POOLED_CONTAINER_NO_SIMD)
+#  if defined(__AVX512F__)
+#    define POOLED_SIMD_AVX512 1
+#    include <immintrin.h>
+#  elif defined(__AVX2__)
+#    define POOLED_SIMD_AVX2 1
+#    include <immintrin.h>
+#  elif defined(__ARM_NEON) && defined(__aarch64__)
+#    define POOLED_SIMD_NEON 1
+#    include <arm_neon.h>
+#  endif
+#endif
+
+namespace pooled_simd {
+
+/// 有 SIMD 内核的键类型 / Key types that have a SIMD kernel
+template <typename T>
+inline constexpr bool supported_v =
+    std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 4 || sizeof(T) == 8);
+
+namespace detail {
+
+inline unsigned popcount(unsigned x) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __popcnt(x);
+#else
+    return static_cast<unsigned>(__builtin_popcount(x));
+#endif
+}
+
+// 标量路径：Greater 为 false 时统计 keys[i] < key，否则统计 keys[i] > key
+// Scalar path: counts keys[i] < key, or keys[i] > key when Greater is set
+template <bool Greater, typename T>
+inline std::size_t count_scalar(const T* keys, std::size_t n, T key) noexcept {
+    std::size_t c = 0;
+    for (std::size_t i = 0; i < n; ++i) c += static_cast<std::size_t>(Greater ? key < keys[i] : keys[i] < key);
+    return c;
+}
+
+#if defined(POOLED_SIMD_AVX512)
+
+template <bool Greater, typename T>
+inline std::size_t count_simd(const T* keys, std::size_t n, T key, std::size_t& done) noexcept {
+    constexpr int cmp = Greater ? _MM_CMPINT_NLE : _MM_CMPINT_LT;
+    constexpr std::size_t lanes = 64 / sizeof(T);
+    std::size_t c = 0;
+    std::size_t i = 0;
+    if constexpr (sizeof(T) == 4) {
+        const __m512i k = _mm512_set1_epi32(static_cast<int>(key));
+        auto mask_of = [&](__mmask16 load, const T* p) {
+            __m512i v = _mm512_maskz_loadu_epi32(load, p);
+            if constexpr (std::is_signed_v<T>) return _mm512_mask_cmp_epi32_mask(load, v, k, cmp);
+            else return _mm512_mask_cmp_epu32_mask(load, v, k, cmp);
+        };
+        for (; i + lanes <= n; i += lanes) c += static_cast<std::size_t>(popcount(mask_of(0xFFFF, keys + i)));
+        if (i < n) {
+            __mmask16 tail = static_cast<__mmask16>((1u << (n - i)) - 1);
+            c += static_cast<std::size_t>(popcount(mask_of(tail, keys + i)));
+        }
+        i = n;
+    } else {
+        const __m512i k = _mm512_set1_epi64(static_cast<long long>(key));
+        auto mask_of = [&](__mmask8 load, const T* p) {
+            __m512i v = _mm512_maskz_loadu_epi64(load, p);
+            if constexpr (std::is_signed_v<T>) return _mm512_mask_cmp_epi64_mask(load, v, k, cmp);
+            else return _mm512_mask_cmp_epu64_mask(load, v, k, cmp);
+        };
+        for (; i + lanes <= n; i += lanes) c += static_cast<std::size_t>(popcount(mask_of(0xFF, keys + i)));
+        if (i < n) {
+            __mmask8 tail = static_cast<__mmask8>((1u << (n - i)) - 1);
+            c += static_cast<std::size_t>(popcount(mask_of(tail, keys + i)));
+        }
+        i = n;
+    }
+    done = i;
+    return c;
+}
+
+#elif defined(POOLED_SIMD_AVX2)
+
+template <bool Greater, typename T>
+inline std::size_t count_simd(const T* keys, std::size_t n, T key, std::size_t& done) noexcept {
+    constexpr std::size_t lanes = 32 / sizeof(T);
+    std::size_t c = 0;
+    std::size_t i = 0;
+    if constexpr (sizeof(T) == 4) {
+        // 无符号键翻转最高位后按有符号比较 / Unsigned keys: flip the top bit, then compare signed
+        const __m256i bias = _mm256_set1_epi32(std::is_signed_v<T> ? 0 : INT32_MIN);
+        const __m256i k = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(key)), bias);
+        for (; i + lanes <= n; i += lanes) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            __m256i m = Greater ? _mm256_cmpgt_epi32(v, k) : _mm256_cmpgt_epi32(k, v);
+            c += static_cast<std::size_t>(popcount(_mm256_movemask_ps(_mm256_castsi256_ps(m))));
+        }
+    } else {
+        const __m256i bias = _mm256_set1_epi64x(std::is_signed_v<T> ? 0 : INT64_MIN);
+        const __m256i k = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(key)), bias);
+        for (; i + lanes <= n; i += lanes) {
+            __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), bias);
+            __m256i m = Greater ? _mm256_cmpgt_epi64(v, k) : _mm256_cmpgt_epi64(k, v);
+            c += static_cast<std::size_t>(popcount(_mm256_movemask_pd(_mm256_castsi256_pd(m))));
+        }
+    }
+    done = i;
+    return c;
+}
+
+#elif defined(POOLED_SIMD_NEON)
+
+template <bool Greater, typename T>
+inline std::size_t count_simd(const T* keys, std::size_t n, T key, std::size_t& done) noexcept {
+    std::size_t c = 0;
+    std::size_t i = 0;
+    if constexpr (sizeof(T) == 4) {
+        // 比较结果通道为全 1（即 -1），逐次相减得到计数 / True lanes are all ones (-1), so subtracting accumulates counts
+        uint32x4_t acc = vdupq_n_u32(0);
+        if constexpr (std::is_signed_v<T>) {
+            const int32x4_t k = vdupq_n_s32(key);
+            for (; i + 4 <= n; i += 4) {
+                int32x4_t v = vld1q_s32(keys + i);
+                acc = vsubq_u32(acc, Greater ? vcgtq_s32(v, k) : vcltq_s32(v, k));
+            }
+        } else {
+            const uint32x4_t k = vdupq_n_u32(key);
+            for (; i + 4 <= n; i += 4) {
+                uint32x4_t v = vld1q_u32(keys + i);
+                acc = vsubq_u32(acc, Greater ? vcgtq_u32(v, k) : vcltq_u32(v, k));
+            }
+        }
+        c = vaddvq_u32(acc);
+    } else {
+        uint64x2_t acc = vdupq_n_u64(0);
+        if constexpr (std::is_signed_v<T>) {
+            const int64x2_t k = vdupq_n_s64(key);
+            for (; i + 2 <= n; i += 2) {
+                int64x2_t v = vld1q_s64(keys + i);
+                acc = vsubq_u64(acc, Greater ? vcgtq_s64(v, k) : vcltq_s64(v, k));
+            }
+        } else {
+            const uint64x2_t k = vdupq_n_u64(key);
+            for (; i + 2 <= n; i += 2) {
+                uint64x2_t v = vld1q_u64(keys + i);
+                acc = vsubq_u64(acc, Greater ? vcgtq_u64(v, k) : vcltq_u64(v, k));
+            }
+        }
+        c = static_cast<std::size_t>(vaddvq_u64(acc));
+    }
+    done = i;
+    return c;
+}
+
+#endif
+
+template <bool Greater, typename T>
+inline std::size_t count(const T* keys, std::size_t n, T key) noexcept {
+#if defined(POOLED_SIMD_AVX512) || defined(POOLED_SIMD_AVX2) || defined(POOLED_SIMD_NEON)
+    if constexpr (supported_v<T>) {
+        // 统一为定长整数类型，避免 long / long long 等同宽别名重复实例化
+        // Normalise to fixed-width types so same-width aliases (long / long long) share one kernel
+        using U = std::conditional_t<sizeof(T) == 4,
+                                     std::conditional_t<std::is_signed_v<T>, std::int32_t, std::uint32_t>,
+                                     std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+        // 内核只处理整向量（AVX-512 含尾部），剩余部分走标量 / Kernels cover whole vectors (AVX-512 also the tail); the rest is scalar
+        std::size_t done = 0;
+        std::size_t c = count_simd<Greater>(reinterpret_cast<const U*>(keys), n, static_cast<U>(key), done);
+        return c + count_scalar<Greater>(keys + done, n - done, key);
+    }
+#endif
+    return count_scalar<Greater>(keys, n, key);
+}
+
+} // namespace detail
+
+/// 小于 key 的键个数，即第一个 >= key 的下标 / Number of keys below key: index of the first key >= key
+template <typename T>
+inline std::size_t count_less(const T* keys, std::size_t n, T key) noexcept {
+    return detail::count<false>(keys, n, key);
+}
+
+/// 不大于 key 的键个数，即第一个 > key 的下标 / Number of keys not above key: index of the first key > key
+template <typename T>
+inline std::size_t count_less_equal(const T* keys, std::size_t n, T key) noexcept {
+    return n - detail::count<true>(keys, n, key);
+}
+
+} // namespace pooled_simd
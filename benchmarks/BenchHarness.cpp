@@ -0,0 +1,225 @@
+//
+//  BenchHarness.cpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  基准框架的驱动：命令行、JSON 输出、基线比较、全局 operator new / delete 替换与 main()。
+//  替换放在独立翻译单元里，调用方看不到其定义，new / delete 的配对检查不会误报。
+//
+//  Harness driver: command line, JSON output, baseline comparison, the global
+//  operator new / delete replacements and main(). The replacements sit in a
+//  translation unit of their own, so callers never see their definitions and
+//  new / delete pairing checks do not misfire.
+//
+
+#include "BenchHarness.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace bench {
+namespace {
+
+void count_allocation(std::size_t bytes) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// ---------- 结果与输出 / Results and output ----------
+
+struct Result {
+    std::string name;
+    const Case* c;
+    std::size_t size;
+    unsigned repetitions;
+    Sample median;
+    bool have_misses;
+
+    double per_op(double v) const { return median.ops ? v / static_cast<double>(median.ops) : 0; }
+};
+
+std::string json_escape(const std::string& s) {
+    std::string out;
+    for (char ch : s) {
+        if (ch == '"' || ch == '\\') out += '\\';
+        out += ch;
+    }
+    return out;
+}
+
+// 每个用例占一行，便于 --baseline 逐行读取 / One case per line, so --baseline can read it line by line
+void write_json(std::FILE* f, const std::vector<Result>& results, std::size_t min_size, std::size_t max_size,
+                       unsigned repetitions, bool have_misses) {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    std::fprintf(f, "{\n  \"context\": {\"date\": \"%s\", \"num_cpus\": %u, \"min_size\": %zu, \"max_size\": %zu, "
+                    "\"repetitions\": %u, \"cache_counters\": %s},\n  \"benchmarks\": [\n",
+                 date, std::thread::hardware_concurrency(), min_size, max_size, repetitions, have_misses ? "true" : "false");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(f, "    {\"name\": \"%s\", \"family\": \"%s\", \"container\": \"%s\", \"key\": \"%s\", "
+                        "\"size\": %zu, \"threads\": %u, \"repetitions\": %u, \"ops\": %llu, \"ns_per_op\": %.3f, "
+                        "\"allocations_per_op\": %.4f, \"allocated_bytes_per_op\": %.2f, ",
+                     json_escape(r.name).c_str(), json_escape(r.c->family).c_str(), json_escape(r.c->container).c_str(),
+                     json_escape(r.c->key).c_str(), r.size, r.c->threads, r.repetitions,
+                     static_cast<unsigned long long>(r.median.ops), r.per_op(r.median.ns),
+                     r.per_op(static_cast<double>(r.median.allocations)), r.per_op(static_cast<double>(r.median.allocated_bytes)));
+        if (r.have_misses) std::fprintf(f, "\"cache_misses_per_op\": %.4f}", r.per_op(static_cast<double>(r.median.cache_misses)));
+        else std::fprintf(f, "\"cache_misses_per_op\": null}");
+        std::fprintf(f, "%s\n", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+}
+
+// 读取 write_json 写出的文件：name -> ns_per_op / Read a file written by write_json: name -> ns_per_op
+std::map<std::string, double> read_baseline(const std::string& path) {
+    std::map<std::string, double> out;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t n = line.find("\"name\": \"");
+        std::size_t t = line.find("\"ns_per_op\": ");
+        if (n == std::string::npos || t == std::string::npos) continue;
+        n += 9;
+        std::size_t end = line.find('"', n);
+        out[line.substr(n, end - n)] = std::strtod(line.c_str() + t + 13, nullptr);
+    }
+    return out;
+}
+
+bool parse_flag(const char* arg, const char* flag, std::string& value) {
+    std::size_t len = std::strlen(flag);
+    if (std::strncmp(arg, flag, len) != 0 || arg[len] != '=') return false;
+    value = arg + len + 1;
+    return true;
+}
+
+int run_main(int argc, char** argv) {
+    std::string filter, json, baseline, v;
+    std::size_t min_size = 1000, max_size = 1000000;
+    unsigned repetitions = 3;
+    double tolerance = 10;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        if (parse_flag(argv[i], "--filter", v)) filter = v;
+        else if (parse_flag(argv[i], "--min-size", v)) min_size = std::strtoull(v.c_str(), nullptr, 10);
+        else if (parse_flag(argv[i], "--max-size", v)) max_size = std::strtoull(v.c_str(), nullptr, 10);
+        else if (parse_flag(argv[i], "--repetitions", v)) repetitions = std::max(1u, static_cast<unsigned>(std::strtoul(v.c_str(), nullptr, 10)));
+        else if (parse_flag(argv[i], "--json", v)) json = v;
+        else if (parse_flag(argv[i], "--baseline", v)) baseline = v;
+        else if (parse_flag(argv[i], "--tolerance", v)) tolerance = std::strtod(v.c_str(), nullptr);
+        else if (std::strcmp(argv[i], "--list") == 0) list = true;
+        else {
+            std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    CacheMissCounter misses;
+    std::vector<Result> results;
+    std::uint64_t sink = 0;
+    static const std::size_t sizes[] = { 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+    for (const Case& c : registry()) {
+        for (std::size_t size : sizes) {
+            if (size < min_size || size > max_size) continue;
+            std::string name = c.name(size);
+            if (!filter.empty() && name.find(filter) == std::string::npos) continue;
+            if (list) {
+                std::printf("%s\n", name.c_str());
+                continue;
+            }
+            std::vector<Sample> samples;
+            for (unsigned r = 0; r < repetitions; ++r) {
+                Run run(size, misses);
+                c.body(run);
+                samples.push_back(run.sample());
+                sink ^= run.sink();
+            }
+            std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.ns < b.ns; });
+            Result res{ name, &c, size, repetitions, samples[samples.size() / 2], misses.available() };
+            std::printf("%-60s %12.2f ns/op %10.4f allocs/op", name.c_str(), res.per_op(res.median.ns),
+                        res.per_op(static_cast<double>(res.median.allocations)));
+            if (res.have_misses) std::printf(" %10.4f misses/op", res.per_op(static_cast<double>(res.median.cache_misses)));
+            std::printf("\n");
+            std::fflush(stdout);
+            results.push_back(std::move(res));
+        }
+    }
+    if (list) return 0;
+    if (!misses.available()) std::printf("(cache-miss counters unavailable: perf_event_open failed)\n");
+
+    if (!json.empty()) {
+        std::FILE* f = std::fopen(json.c_str(), "w");
+        if (!f) {
+            std::fprintf(stderr, "cannot write %s\n", json.c_str());
+            return 2;
+        }
+        write_json(f, results, min_size, max_size, repetitions, misses.available());
+        std::fclose(f);
+    }
+
+    int status = 0;
+    if (!baseline.empty()) {
+        std::map<std::string, double> base = read_baseline(baseline);
+        std::size_t compared = 0, regressed = 0;
+        for (const Result& r : results) {
+            auto it = base.find(r.name);
+            if (it == base.end() || it->second <= 0) continue;
+            ++compared;
+            double change = (r.per_op(r.median.ns) / it->second - 1) * 100;
+            if (change > tolerance) {
+                ++regressed;
+                std::printf("REGRESSION %-60s %+.1f%% (%.2f -> %.2f ns/op)\n", r.name.c_str(), change, it->second,
+                            r.per_op(r.median.ns));
+            }
+        }
+        std::printf("baseline: %zu compared, %zu slower than %.1f%%\n", compared, regressed, tolerance);
+        if (regressed) status = 1;
+    }
+    // 让编译器无法证明结果无用 / Make sure the compiler cannot prove the results unused
+    if (sink == 0x5eed) std::printf(" \n");
+    return status;
+}
+
+} // namespace
+} // namespace bench
+
+// ---------- 全局 operator new / delete 替换，统计分配 / Global operator new / delete replacements that count allocations ----------
+
+void* operator new(std::size_t n) {
+    bench::count_allocation(n);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) { return ::operator new(n); }
+
+void* operator new(std::size_t n, std::align_val_t align) {
+    bench::count_allocation(n);
+    std::size_t a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (n + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t align) { return ::operator new(n, align); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+// 其余形式都转给 operator delete(void*)，释放只有一处 / Every other form forwards to operator delete(void*), so memory is freed in one place
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { ::operator delete(p); }
+
+int main(int argc, char** argv) { return bench::run_main(argc, argv); }
@@ -0,0 +1,179 @@
+//
+//  BenchHarness.hpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  基准测试框架：注册、计时、分配与缓存未命中计数。命令行解析、JSON 输出、基线比较、
+//  全局 operator new / delete 替换与 main() 在 BenchHarness.cpp 中，与用例文件一起链接。
+//
+//  Benchmark harness: registration, timing, allocation and cache-miss
+//  counters. Command-line parsing, JSON output, baseline comparison, the
+//  global operator new / delete replacements and main() live in
+//  BenchHarness.cpp, which is linked together with the case files.
+//
+//  命令行 / Command line:
+//    --filter=<子串 / substring>     只运行名字包含该子串的用例 / run only cases whose name contains it
+//    --min-size=<n> --max-size=<n>   规模范围，默认 1000 .. 1000000 / size range, default 1000 .. 1000000
+//    --repetitions=<n>               每个用例重复次数，报告中位数，默认 3 / repetitions per case, the median is reported (default 3)
+//    --json=<path>                   结果写成 JSON / write the results as JSON
+//    --baseline=<path>               与之前的 JSON 比较，变慢超过容差时退出码为 1 / compare against an earlier JSON; exit 1 on regressions
+//    --tolerance=<百分比 / percent>  默认 10 / default 10
+//    --list                          只列出用例名 / list case names only
+//
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace bench {
+
+// ---------- 分配计数，由 BenchHarness.cpp 中替换的 operator new 累加 / Allocation counters, bumped by the operator new replaced in BenchHarness.cpp ----------
+
+inline std::atomic<std::uint64_t> g_allocations{0};
+inline std::atomic<std::uint64_t> g_allocated_bytes{0};
+
+// ---------- 缓存未命中计数（Linux perf_event，不可用时报告 null）/ Cache-miss counting (Linux perf_event; null when unavailable) ----------
+
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.inherit = 1;           // 计入计时区内创建的线程 / count threads created inside the timed region
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) ::close(fd_);
+#endif
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const noexcept { return fd_ >= 0; }
+
+    void start() noexcept {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ::ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    std::uint64_t stop() noexcept {
+        std::uint64_t value = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ::ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (::read(fd_, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) value = 0;
+#endif
+        return value;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+// ---------- 用例 / Cases ----------
+
+/// 一次测量的结果 / One measurement
+struct Sample {
+    double ns = 0;
+    std::uint64_t ops = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t allocated_bytes = 0;
+    std::uint64_t cache_misses = 0;
+};
+
+/**
+ * @brief 传给用例的运行上下文 / Run context handed to a case
+ *
+ * 准备数据的代码不计时；只有 measure() 包住的部分计入时间与计数。
+ * 同一用例中可调用多次，结果累加。
+ * Setup code is not timed; only what measure() wraps counts towards time
+ * and counters. It may be called several times per case and accumulates.
+ */
+class Run {
+public:
+    Run(std::size_t size, CacheMissCounter& misses) : size_(size), misses_(misses) {}
+
+    std::size_t size() const noexcept { return size_; }
+
+    template <typename Body>
+    void measure(std::uint64_t ops, Body&& body) {
+        std::uint64_t allocs = g_allocations.load(std::memory_order_relaxed);
+        std::uint64_t bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+        misses_.start();
+        auto t0 = std::chrono::steady_clock::now();
+        body();
+        auto t1 = std::chrono::steady_clock::now();
+        sample_.cache_misses += misses_.stop();
+        sample_.allocations += g_allocations.load(std::memory_order_relaxed) - allocs;
+        sample_.allocated_bytes += g_allocated_bytes.load(std::memory_order_relaxed) - bytes;
+        sample_.ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+        sample_.ops += ops;
+    }
+
+    /// 防止结果被优化掉 / Keep a result from being optimized away
+    template <typename T>
+    void keep(const T& value) noexcept {
+        sink_ ^= static_cast<std::uint64_t>(std::hash<T>()(value));
+    }
+
+    const Sample& sample() const noexcept { return sample_; }
+    std::uint64_t sink() const noexcept { return sink_; }
+
+private:
+    std::size_t size_;
+    CacheMissCounter& misses_;
+    Sample sample_;
+    std::uint64_t sink_ = 0;
+};
+
+struct Case {
+    std::string family;      ///< 如 "map/insert" / e.g. "map/insert"
+    std::string container;   ///< 如 "PooledMap" / e.g. "PooledMap"
+    std::string key;         ///< 键或元素类型 / key or element type
+    unsigned threads = 1;
+    std::function<void(Run&)> body;
+
+    std::string name(std::size_t size) const {
+        std::string n = family + "/" + container + "/" + key;
+        if (threads > 1) n += "/threads:" + std::to_string(threads);
+        return n + "/" + std::to_string(size);
+    }
+};
+
+inline std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+inline void add(std::string family, std::string container, std::string key, std::function<void(Run&)> body,
+                unsigned threads = 1) {
+    registry().push_back({ std::move(family), std::move(container), std::move(key), threads, std::move(body) });
+}
+
+} // namespace bench
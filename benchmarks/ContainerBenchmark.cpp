@@ -0,0 +1,350 @@
+//
+//  ContainerBenchmark.cpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  可复现的容器基准套件：PooledMap 对比 std::map / std::unordered_map，
+//  PooledList 对比 std::list / std::deque。键类型 int、20 字节 std::string、64 字节结构体，
+//  操作含插入、查找、删除、遍历、插删混合（churn）与多线程。随机序列使用固定种子，
+//  每次运行的输入相同。计时、分配计数、缓存未命中与 JSON 输出见 BenchHarness.hpp / .cpp。
+//
+//  Reproducible container suite: PooledMap against std::map /
+//  std::unordered_map, PooledList against std::list / std::deque. Keys are
+//  int, a 20-byte std::string and a 64-byte struct; operations are insert,
+//  find, erase, traverse, churn (interleaved insert / erase) and
+//  multi-threaded. Random sequences use fixed seeds, so every run sees the
+//  same input. Timing, allocation counts, cache misses and JSON output live
+//  in BenchHarness.hpp / .cpp.
+//
+//  用法 / Usage: ContainerBenchmark [--filter=map/find] [--max-size=100000000] [--json=out.json]
+//                                   [--baseline=old.json --tolerance=10]
+//
+
+#include "../PooledMap.hpp"
+#include "../PooledList"
+#include "BenchHarness.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// ---------- 键类型 / Key types ----------
+
+/// 64 字节键，按 id 比较 / 64-byte key compared by id
+struct Large {
+    std::uint64_t id;
+    char payload[56];
+
+    bool operator<(const Large& o) const noexcept { return id < o.id; }
+    bool operator==(const Large& o) const noexcept { return id == o.id; }
+};
+
+struct LargeHash {
+    std::size_t operator()(const Large& k) const noexcept { return std::hash<std::uint64_t>()(k.id); }
+};
+
+template <typename K> K make_key(std::uint64_t i);
+
+template <> int make_key<int>(std::uint64_t i) { return static_cast<int>(i); }
+
+// 定长 20 字符，超出 SSO，前缀相同以体现比较开销 / Fixed 20 chars, beyond SSO, with a shared prefix so comparisons do real work
+template <> std::string make_key<std::string>(std::uint64_t i) {
+    char buf[21];
+    std::snprintf(buf, sizeof(buf), "key:%016llu", static_cast<unsigned long long>(i));
+    return std::string(buf, 20);
+}
+
+template <> Large make_key<Large>(std::uint64_t i) {
+    Large k;
+    k.id = i;
+    std::memset(k.payload, static_cast<int>(i & 0x7f), sizeof(k.payload));
+    return k;
+}
+
+template <typename K> const char* key_name();
+template <> const char* key_name<int>() { return "int"; }
+template <> const char* key_name<std::string>() { return "string"; }
+template <> const char* key_name<Large>() { return "large"; }
+
+template <typename K> struct KeyHash : std::hash<K> {};
+template <> struct KeyHash<Large> : LargeHash {};
+
+std::uint64_t key_id(int k) { return static_cast<std::uint64_t>(k); }
+std::uint64_t key_id(const std::string& k) { return static_cast<unsigned char>(k.back()); }
+std::uint64_t key_id(const Large& k) { return k.id; }
+
+/// 0 .. n-1 的固定随机排列 / Fixed random permutation of 0 .. n-1
+std::vector<std::uint64_t> shuffled(std::size_t n, std::uint64_t seed) {
+    std::vector<std::uint64_t> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    std::shuffle(v.begin(), v.end(), std::mt19937_64(seed));
+    return v;
+}
+
+template <typename K>
+std::vector<K> make_keys(const std::vector<std::uint64_t>& ids) {
+    std::vector<K> keys;
+    keys.reserve(ids.size());
+    for (std::uint64_t i : ids) keys.push_back(make_key<K>(i));
+    return keys;
+}
+
+// ---------- 映射适配 / Map adapters ----------
+
+using Value = std::uint64_t;
+
+template <typename K> using PooledMapOf = PooledMap<K, Value>;
+template <typename K> using PooledMapTL = PooledMap<K, Value, std::less<>, ThreadLocalPoolPolicy>;
+template <typename K> using StdMapOf = std::map<K, Value>;
+template <typename K> using StdHashOf = std::unordered_map<K, Value, KeyHash<K>>;
+
+template <typename K, typename C, typename P, bool O>
+const Value* lookup(const PooledMap<K, Value, C, P, O>& m, const K& k) { return m.find_ptr(k); }
+
+template <typename M, typename K>
+const Value* lookup(const M& m, const K& k) {
+    auto it = m.find(k);
+    return it == m.end() ? nullptr : &it->second;
+}
+
+template <typename K, typename C, typename P, bool O>
+std::uint64_t traverse(const PooledMap<K, Value, C, P, O>& m) {
+    std::uint64_t sum = 0;
+    m.for_each([&](const K&, const Value& v) { sum += v; });
+    return sum;
+}
+
+template <typename M>
+std::uint64_t traverse(const M& m) {
+    std::uint64_t sum = 0;
+    for (const auto& kv : m) sum += kv.second;
+    return sum;
+}
+
+template <typename M, typename K>
+void fill(M& m, const std::vector<K>& keys) {
+    for (std::size_t i = 0; i < keys.size(); ++i) m.emplace(keys[i], static_cast<Value>(i));
+}
+
+// ---------- 映射用例 / Map cases ----------
+
+template <typename M, typename K>
+void map_insert(bench::Run& run) {
+    std::vector<K> keys = make_keys<K>(shuffled(run.size(), 1));
+    M m;
+    run.measure(keys.size(), [&] { fill(m, keys); });
+    run.keep(m.size());
+}
+
+template <typename M, typename K>
+void map_find(bench::Run& run) {
+    std::vector<K> keys = make_keys<K>(shuffled(run.size(), 1));
+    M m;
+    fill(m, keys);
+    // 一半命中一半未命中 / Half hits, half misses
+    std::vector<std::uint64_t> ids = shuffled(run.size() * 2, 2);
+    ids.resize(run.size());
+    std::vector<K> probes = make_keys<K>(ids);
+    std::uint64_t found = 0;
+    run.measure(probes.size(), [&] {
+        for (const K& k : probes)
+            if (const Value* v = lookup(m, k)) found += *v;
+    });
+    run.keep(found);
+}
+
+template <typename M, typename K>
+void map_erase(bench::Run& run) {
+    std::vector<K> keys = make_keys<K>(shuffled(run.size(), 1));
+    M m;
+    fill(m, keys);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(3));
+    std::size_t erased = 0;
+    run.measure(keys.size(), [&] {
+        for (const K& k : keys) erased += m.erase(k);
+    });
+    run.keep(erased);
+}
+
+template <typename M, typename K>
+void map_traverse(bench::Run& run) {
+    // 插删之后再遍历，节点不再按插入顺序排布 / Traverse after churn, so nodes no longer sit in insertion order
+    std::vector<K> keys = make_keys<K>(shuffled(run.size(), 1));
+    M m;
+    fill(m, keys);
+    for (std::size_t i = 0; i < keys.size(); i += 2) m.erase(keys[i]);
+    for (std::size_t i = 0; i < keys.size(); i += 2) m.emplace(keys[i], static_cast<Value>(i));
+    std::uint64_t sum = 0;
+    run.measure(m.size(), [&] { sum = traverse(m); });
+    run.keep(sum);
+}
+
+template <typename M, typename K>
+void map_churn(bench::Run& run) {
+    // 稳态规模 size：每步删除一个旧键、插入一个新键 / Steady state of size keys: each step erases an old key and inserts a new one
+    std::size_t n = run.size();
+    std::vector<K> keys = make_keys<K>(shuffled(n * 2, 4));
+    M m;
+    for (std::size_t i = 0; i < n; ++i) m.emplace(keys[i], static_cast<Value>(i));
+    run.measure(n * 2, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            m.erase(keys[i]);
+            m.emplace(keys[n + i], static_cast<Value>(i));
+        }
+    });
+    run.keep(m.size());
+}
+
+/// 每个线程一个独立映射：插入后查找，共 size 个键 / One private map per thread: insert then find, size keys in total
+template <typename M, typename K, unsigned Threads>
+void map_threads(bench::Run& run) {
+    std::size_t per = std::max<std::size_t>(1, run.size() / Threads);
+    std::vector<std::vector<K>> keys;
+    for (unsigned t = 0; t < Threads; ++t) keys.push_back(make_keys<K>(shuffled(per, 10 + t)));
+    std::vector<std::uint64_t> found(Threads);
+    run.measure(per * Threads * 2, [&] {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < Threads; ++t)
+            workers.emplace_back([&, t] {
+                M m;
+                fill(m, keys[t]);
+                std::uint64_t sum = 0;
+                for (const K& k : keys[t])
+                    if (const Value* v = lookup(m, k)) sum += *v;
+                found[t] = sum;
+            });
+        for (std::thread& w : workers) w.join();
+    });
+    run.keep(std::accumulate(found.begin(), found.end(), std::uint64_t(0)));
+}
+
+constexpr unsigned kThreads = 4;
+
+template <typename K>
+void register_maps() {
+    const std::string key = key_name<K>();
+    bench::add("map/insert", "PooledMap", key, map_insert<PooledMapOf<K>, K>);
+    bench::add("map/insert", "std::map", key, map_insert<StdMapOf<K>, K>);
+    bench::add("map/insert", "std::unordered_map", key, map_insert<StdHashOf<K>, K>);
+    bench::add("map/find", "PooledMap", key, map_find<PooledMapOf<K>, K>);
+    bench::add("map/find", "std::map", key, map_find<StdMapOf<K>, K>);
+    bench::add("map/find", "std::unordered_map", key, map_find<StdHashOf<K>, K>);
+    bench::add("map/erase", "PooledMap", key, map_erase<PooledMapOf<K>, K>);
+    bench::add("map/erase", "std::map", key, map_erase<StdMapOf<K>, K>);
+    bench::add("map/erase", "std::unordered_map", key, map_erase<StdHashOf<K>, K>);
+    bench::add("map/traverse", "PooledMap", key, map_traverse<PooledMapOf<K>, K>);
+    bench::add("map/traverse", "std::map", key, map_traverse<StdMapOf<K>, K>);
+    bench::add("map/traverse", "std::unordered_map", key, map_traverse<StdHashOf<K>, K>);
+    bench::add("map/churn", "PooledMap", key, map_churn<PooledMapOf<K>, K>);
+    bench::add("map/churn", "std::map", key, map_churn<StdMapOf<K>, K>);
+    bench::add("map/churn", "std::unordered_map", key, map_churn<StdHashOf<K>, K>);
+    // 多线程用线程本地池，默认段式池不承诺跨线程并发创建 / Threads use the thread-local pool; the default segmented pool makes no promise about concurrent creation
+    bench::add("map/threads", "PooledMap<ThreadLocal>", key, map_threads<PooledMapTL<K>, K, kThreads>, kThreads);
+    bench::add("map/threads", "std::map", key, map_threads<StdMapOf<K>, K, kThreads>, kThreads);
+    bench::add("map/threads", "std::unordered_map", key, map_threads<StdHashOf<K>, K, kThreads>, kThreads);
+}
+
+// ---------- 序列用例 / Sequence cases ----------
+
+template <typename L, typename K>
+void list_push_back(bench::Run& run) {
+    std::vector<K> values = make_keys<K>(shuffled(run.size(), 5));
+    L l;
+    run.measure(values.size(), [&] {
+        for (const K& v : values) l.push_back(v);
+    });
+    run.keep(l.size());
+}
+
+template <typename T, typename P>
+std::uint64_t sum_ids(const PooledList<T, P>& l) {
+    std::uint64_t sum = 0;
+    l.for_each([&](const T& v) { sum += key_id(v); });
+    return sum;
+}
+
+template <typename L>
+std::uint64_t sum_ids(const L& l) {
+    std::uint64_t sum = 0;
+    for (const auto& v : l) sum += key_id(v);
+    return sum;
+}
+
+template <typename L, typename K>
+void list_traverse(bench::Run& run) {
+    std::vector<K> values = make_keys<K>(shuffled(run.size(), 5));
+    L l;
+    for (const K& v : values) l.push_back(v);
+    std::uint64_t sum = 0;
+    run.measure(values.size(), [&] { sum = sum_ids(l); });
+    run.keep(sum);
+}
+
+/// 队列式插删：保持 size 个元素，尾进头出 / Queue churn: hold size elements, push at the back and pop at the front
+template <typename L, typename K>
+void list_churn(bench::Run& run) {
+    std::size_t n = run.size();
+    std::vector<K> values = make_keys<K>(shuffled(n, 6));
+    L l;
+    for (const K& v : values) l.push_back(v);
+    run.measure(n * 2, [&] {
+        for (const K& v : values) {
+            l.pop_front();
+            l.push_back(v);
+        }
+    });
+    run.keep(l.size());
+}
+
+/// 按位置随机访问；std::list 无此操作 / Random positional access; std::list has none
+template <typename L, typename K>
+void list_index(bench::Run& run) {
+    std::vector<K> values = make_keys<K>(shuffled(run.size(), 7));
+    L l;
+    for (const K& v : values) l.push_back(v);
+    std::vector<std::uint64_t> positions = shuffled(run.size(), 8);
+    std::uint64_t sum = 0;
+    run.measure(positions.size(), [&] {
+        for (std::uint64_t p : positions) sum += key_id(l[p]);
+    });
+    run.keep(sum);
+}
+
+template <typename K>
+void register_lists() {
+    const std::string key = key_name<K>();
+    bench::add("list/push_back", "PooledList", key, list_push_back<PooledList<K>, K>);
+    bench::add("list/push_back", "std::list", key, list_push_back<std::list<K>, K>);
+    bench::add("list/push_back", "std::deque", key, list_push_back<std::deque<K>, K>);
+    bench::add("list/traverse", "PooledList", key, list_traverse<PooledList<K>, K>);
+    bench::add("list/traverse", "std::list", key, list_traverse<std::list<K>, K>);
+    bench::add("list/traverse", "std::deque", key, list_traverse<std::deque<K>, K>);
+    bench::add("list/churn", "PooledList", key, list_churn<PooledList<K>, K>);
+    bench::add("list/churn", "std::list", key, list_churn<std::list<K>, K>);
+    bench::add("list/churn", "std::deque", key, list_churn<std::deque<K>, K>);
+    bench::add("list/index", "PooledList", key, list_index<PooledList<K>, K>);
+    bench::add("list/index", "std::deque", key, list_index<std::deque<K>, K>);
+}
+
+// 静态注册，在 main() 之前完成 / Static registration, done before main()
+[[maybe_unused]] const bool registered = [] {
+    register_maps<int>();
+    register_maps<std::string>();
+    register_maps<Large>();
+    register_lists<int>();
+    register_lists<std::string>();
+    register_lists<Large>();
+    return true;
+}();
+
+} // namespace
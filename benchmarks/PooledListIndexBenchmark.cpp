@@ -0,0 +1,134 @@
+//
+//  PooledListIndexBenchmark.cpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  PooledList 位置索引对比测试：隐式 Treap 索引 vs 旧版 unordered_map 平移索引。
+//  Positional index comparison: implicit treap index vs the former
+//  unordered_map index that shifted every entry after the change point.
+//
+//  旧版索引逻辑在下方 LegacyHashIndexedList 中原样复现，节点使用 new/delete，
+//  因此差异只来自索引维护本身。
+//  The former index maintenance is reproduced verbatim in LegacyHashIndexedList
+//  below (nodes use plain new/delete), so the difference comes from the index alone.
+//
+
+#include "../PooledList"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unordered_map>
+
+namespace {
+
+template <typename T>
+class LegacyHashIndexedList {
+    struct Node {
+        T _value;
+        Node* _prev = nullptr;
+        Node* _next = nullptr;
+        explicit Node(const T& v) : _value(v) {}
+    };
+    Node* _head = nullptr;
+    Node* _tail = nullptr;
+    std::size_t _size = 0;
+    std::unordered_map<std::size_t, Node*> _hashIndex;
+
+public:
+    ~LegacyHashIndexedList() {
+        for (Node* cur = _head; cur;) { Node* next = cur->_next; delete cur; cur = next; }
+    }
+
+    std::size_t size() const { return _size; }
+
+    void push_front(const T& v) {
+        Node* n = new Node(v);
+        if (!_head) _head = _tail = n;
+        else { n->_next = _head; _head->_prev = n; _head = n; }
+        for (std::size_t i = _size; i > 0; --i) _hashIndex[i] = _hashIndex[i - 1];
+        _hashIndex[0] = n;
+        ++_size;
+    }
+
+    void insert(std::size_t pos, const T& v) {
+        Node* n = new Node(v);
+        if (pos == 0) {
+            n->_next = _head;
+            if (_head) _head->_prev = n;
+            _head = n;
+            if (!_tail) _tail = n;
+        } else if (pos == _size) {
+            n->_prev = _tail;
+            _tail->_next = n;
+            _tail = n;
+        } else {
+            Node* cur = _hashIndex.at(pos);
+            Node* prev = cur->_prev;
+            prev->_next = n; n->_prev = prev; n->_next = cur; cur->_prev = n;
+        }
+        for (std::size_t i = _size; i > pos; --i) _hashIndex[i] = _hashIndex[i - 1];
+        _hashIndex[pos] = n;
+        ++_size;
+    }
+
+    void erase(std::size_t idx) {
+        Node* n = _hashIndex.at(idx);
+        if (n->_prev) n->_prev->_next = n->_next; else _head = n->_next;
+        if (n->_next) n->_next->_prev = n->_prev; else _tail = n->_prev;
+        delete n;
+        --_size;
+        for (std::size_t i = idx; i < _size; ++i) _hashIndex[i] = _hashIndex[i + 1];
+        _hashIndex.erase(_size);
+    }
+
+    T& operator[](std::size_t idx) { return _hashIndex.at(idx)->_value; }
+};
+
+using Clock = std::chrono::steady_clock;
+
+long long elapsed_ms(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - since).count();
+}
+
+template <typename List>
+void run(const char* name, std::size_t n) {
+    std::mt19937_64 rng(42);
+    List list;
+    long long checksum = 0;
+
+    auto t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) list.push_front(static_cast<int>(i));
+    long long front = elapsed_ms(t0);
+
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) list.insert(rng() % (list.size() + 1), static_cast<int>(i));
+    long long middle = elapsed_ms(t0);
+
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) checksum += list[rng() % list.size()];
+    long long access = elapsed_ms(t0);
+
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) list.erase(rng() % list.size());
+    long long erase = elapsed_ms(t0);
+
+    std::printf("==== %s, n = %zu ====\n", name, n);
+    std::printf("push_front: %lld ms\n", front);
+    std::printf("insert(random pos): %lld ms\n", middle);
+    std::printf("operator[](random): %lld ms\n", access);
+    std::printf("erase(random pos): %lld ms\n", erase);
+    std::printf("Total: %lld ms (checksum %lld)\n\n", front + middle + access + erase, checksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // 旧版索引为 O(n^2)，默认只测到 10 万 / The legacy index is O(n^2); by default it stops at 100K
+    std::size_t legacy_limit = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+    for (std::size_t n : {1000u, 10000u, 100000u, 1000000u}) {
+        run<PooledList<int>>("PooledList (implicit treap index)", n);
+        if (n <= legacy_limit) run<LegacyHashIndexedList<int>>("Legacy unordered_map shifting index", n);
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  PooledUnrolledListBenchmark.cpp
+//
+//  Copyright (c) 2025 大熊哥哥 (Bighiung). All rights reserved.
+//
+//  展开链表对比测试：PooledUnrolledList vs PooledList，顺序扫描另与 std::vector 对照。
+//  Unrolled list comparison: PooledUnrolledList vs PooledList, with
+//  std::vector as the reference for sequential scans.
+//
+
+#include "../PooledList"
+#include "../PooledUnrolledList.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+long long elapsed_us(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count();
+}
+
+template <typename List>
+void run(const char* name, std::size_t n) {
+    std::mt19937_64 rng(42);
+    List list;
+    long long checksum = 0;
+
+    auto t0 = Clock::now();
+    for (std::size_t i = 0; i < n; ++i) list.push_back(static_cast<int>(i));
+    long long back = elapsed_us(t0);
+
+    t0 = Clock::now();
+    for (int r = 0; r < 10; ++r) list.for_each([&checksum](int v) { checksum += v; });
+    long long scan = elapsed_us(t0) / 10;
+
+    std::size_t edits = n / 100;
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < edits; ++i) list.insert(rng() % (list.size() + 1), static_cast<int>(i));
+    for (std::size_t i = 0; i < edits; ++i) list.erase(rng() % list.size());
+    long long edit = elapsed_us(t0);
+
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < edits; ++i) checksum += list[rng() % list.size()];
+    long long access = elapsed_us(t0);
+
+    std::printf("==== %s, n = %zu ====\n", name, n);
+    std::printf("push_back: %lld us\n", back);
+    std::printf("for_each scan: %lld us\n", scan);
+    std::printf("insert + erase (random pos, %zu each): %lld us\n", edits, edit);
+    std::printf("operator[](random, %zu): %lld us (checksum %lld)\n\n", edits, access, checksum);
+}
+
+void run_vector_scan(std::size_t n) {
+    std::vector<int> v;
+    for (std::size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+    long long checksum = 0;
+    auto t0 = Clock::now();
+    for (int r = 0; r < 10; ++r) {
+        for (int x : v) checksum += x;
+    }
+    std::printf("==== std::vector, n = %zu ====\nfor_each scan: %lld us (checksum %lld)\n\n", n, elapsed_us(t0) / 10, checksum);
+}
+
+} // namespace
+
+int main() {
+    for (std::size_t n : {10000u, 1000000u, 10000000u}) {
+        run<PooledList<int>>("PooledList", n);
+        run<PooledUnrolledList<int>>("PooledUnrolledList (64 per chunk)", n);
+        run_vector_scan(n);
+    }
+}